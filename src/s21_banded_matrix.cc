@@ -0,0 +1,306 @@
+#include "s21_banded_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+#include "s21_matrix_kernels.h"
+
+S21TridiagonalMatrix::S21TridiagonalMatrix(int size)
+    : S21TridiagonalMatrix(
+          std::vector<double>(std::max(size - 1, 0)),
+          std::vector<double>(std::max(size, 0)),
+          std::vector<double>(std::max(size - 1, 0))) {}
+
+S21TridiagonalMatrix::S21TridiagonalMatrix(std::vector<double> lower,
+                                           std::vector<double> diagonal,
+                                           std::vector<double> upper)
+    : lower_(std::move(lower)),
+      diagonal_(std::move(diagonal)),
+      upper_(std::move(upper)) {
+  if (diagonal_.empty() || lower_.size() + 1 != diagonal_.size() ||
+      upper_.size() + 1 != diagonal_.size()) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+}
+
+S21TridiagonalMatrix S21TridiagonalMatrix::FromDense(const S21Matrix &m) {
+  if (m.GetRows() != m.GetCols()) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  }
+  S21TridiagonalMatrix result(m.GetRows());
+  for (int i = 0; i < result.GetSize(); ++i) {
+    result.diagonal_[i] = m(i, i);
+    if (i == 0) continue;
+    result.lower_[i - 1] = m(i, i - 1);
+    result.upper_[i - 1] = m(i - 1, i);
+  }
+  return result;
+}
+
+double &S21TridiagonalMatrix::operator()(int row, int col) {
+  int n = GetSize();
+  if (row < 0 || col < 0 || row >= n || col >= n || std::abs(row - col) > 1) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  if (row == col) return diagonal_[row];
+  return row > col ? lower_[col] : upper_[row];
+}
+
+double S21TridiagonalMatrix::operator()(int row, int col) const {
+  int n = GetSize();
+  if (row < 0 || col < 0 || row >= n || col >= n) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  if (row == col) return diagonal_[row];
+  if (row == col + 1) return lower_[col];
+  if (col == row + 1) return upper_[row];
+  return 0.0;
+}
+
+S21Matrix S21TridiagonalMatrix::ToDense() const {
+  int n = GetSize();
+  S21Matrix result(n, n);
+  for (int i = 0; i < n; ++i) {
+    result(i, i) = diagonal_[i];
+    if (i == 0) continue;
+    result(i, i - 1) = lower_[i - 1];
+    result(i - 1, i) = upper_[i - 1];
+  }
+  return result;
+}
+
+S21Matrix S21TridiagonalMatrix::Multiply(const S21Matrix &b,
+                                         S21ExecutionPolicy policy) const {
+  int n = GetSize(), m = b.GetCols();
+  S21CheckRows(n, b);
+  S21Matrix storage;
+  const S21Matrix &rows = S21Matrix::RowMajor(b, storage);
+  const double *b_data = rows.Data();
+  std::size_t b_stride = rows.Stride();
+  S21Matrix result(n, m);
+  double *c_data = result.Data();
+  std::size_t c_stride = result.Stride();
+  S21ForRows(n, 256, policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *c_row = c_data + i * c_stride;
+      const double *b_row = b_data + i * b_stride;
+      for (int j = 0; j < m; ++j) c_row[j] = diagonal_[i] * b_row[j];
+      if (i > 0) {
+        const double *above = b_row - b_stride;
+        for (int j = 0; j < m; ++j) c_row[j] += lower_[i - 1] * above[j];
+      }
+      if (i + 1 < n) {
+        const double *below = b_row + b_stride;
+        for (int j = 0; j < m; ++j) c_row[j] += upper_[i] * below[j];
+      }
+    }
+  });
+  return result;
+}
+
+// Прямой ход: c[i] = u[i] / p[i], x[i] = (b[i] - l[i-1] x[i-1]) / p[i],
+// где p[i] = d[i] - l[i-1] c[i-1]; обратный: x[i] -= c[i] x[i+1]
+S21Matrix S21TridiagonalMatrix::Solve(const S21Matrix &b) const {
+  int n = GetSize(), m = b.GetCols();
+  S21CheckRows(n, b);
+  S21Matrix x = b.InLayout(S21Layout::kRowMajor);
+  double *data = x.Data();
+  std::size_t stride = x.Stride();
+  std::vector<double> ratio(n);
+  for (int i = 0; i < n; ++i) {
+    double *row = data + i * stride;
+    double pivot = diagonal_[i];
+    if (i > 0) {
+      pivot -= lower_[i - 1] * ratio[i - 1];
+      const double *above = row - stride;
+      for (int j = 0; j < m; ++j) row[j] -= lower_[i - 1] * above[j];
+    }
+    // порог относительно строки: масштаб матрицы (например, h^2 в
+    // разностных схемах) не должен отправлять систему в запасной путь
+    double scale = std::fabs(diagonal_[i]);
+    if (i > 0) scale += std::fabs(lower_[i - 1]);
+    if (i + 1 < n) scale += std::fabs(upper_[i]);
+    if (std::fabs(pivot) <= EPS * scale) {
+      return S21BandedMatrix(*this).Solve(b);
+    }
+    if (i + 1 < n) ratio[i] = upper_[i] / pivot;
+    for (int j = 0; j < m; ++j) row[j] /= pivot;
+  }
+  for (int i = n - 2; i >= 0; --i) {
+    double *row = data + i * stride;
+    const double *below = row + stride;
+    for (int j = 0; j < m; ++j) row[j] -= ratio[i] * below[j];
+  }
+  return x;
+}
+
+S21BandedMatrix::S21BandedMatrix(int size, int lower_bandwidth,
+                                 int upper_bandwidth)
+    : size_(size), kl_(lower_bandwidth), ku_(upper_bandwidth) {
+  if (size <= 0 || kl_ < 0 || ku_ < 0 || kl_ >= size || ku_ >= size) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  band_.assign(static_cast<std::size_t>(size_) * (kl_ + ku_ + 1), 0.0);
+}
+
+S21BandedMatrix::S21BandedMatrix(const S21TridiagonalMatrix &m)
+    : S21BandedMatrix(m.GetSize(), m.GetSize() > 1, m.GetSize() > 1) {
+  for (int i = 0; i < size_; ++i) {
+    (*this)(i, i) = m.Diagonal()[i];
+    if (i == 0) continue;
+    (*this)(i, i - 1) = m.Lower()[i - 1];
+    (*this)(i - 1, i) = m.Upper()[i - 1];
+  }
+}
+
+S21BandedMatrix S21BandedMatrix::FromDense(const S21Matrix &m,
+                                           int lower_bandwidth,
+                                           int upper_bandwidth) {
+  if (m.GetRows() != m.GetCols()) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  }
+  S21BandedMatrix result(m.GetRows(), lower_bandwidth, upper_bandwidth);
+  for (int i = 0; i < result.size_; ++i) {
+    int last = std::min(result.size_ - 1, i + result.ku_);
+    for (int j = std::max(0, i - result.kl_); j <= last; ++j) {
+      result(i, j) = m(i, j);
+    }
+  }
+  return result;
+}
+
+void S21BandedMatrix::CheckIndex(int row, int col) const {
+  if (row < 0 || col < 0 || row >= size_ || col >= size_) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+}
+
+double &S21BandedMatrix::operator()(int row, int col) {
+  CheckIndex(row, col);
+  if (!InBand(row, col)) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  return band_[static_cast<std::size_t>(row) * (kl_ + ku_ + 1) +
+               (col - row + kl_)];
+}
+
+double S21BandedMatrix::operator()(int row, int col) const {
+  CheckIndex(row, col);
+  if (!InBand(row, col)) return 0.0;
+  return band_[static_cast<std::size_t>(row) * (kl_ + ku_ + 1) +
+               (col - row + kl_)];
+}
+
+S21Matrix S21BandedMatrix::ToDense() const {
+  S21Matrix result(size_, size_);
+  for (int i = 0; i < size_; ++i) {
+    int last = std::min(size_ - 1, i + ku_);
+    for (int j = std::max(0, i - kl_); j <= last; ++j) {
+      result(i, j) = (*this)(i, j);
+    }
+  }
+  return result;
+}
+
+// Строка результата - сумма не больше kl + ku + 1 строк b
+S21Matrix S21BandedMatrix::Multiply(const S21Matrix &b,
+                                    S21ExecutionPolicy policy) const {
+  int m = b.GetCols();
+  S21CheckRows(size_, b);
+  S21Matrix storage;
+  const S21Matrix &rows = S21Matrix::RowMajor(b, storage);
+  const double *b_data = rows.Data();
+  std::size_t b_stride = rows.Stride();
+  S21Matrix result(size_, m);
+  double *c_data = result.Data();
+  std::size_t c_stride = result.Stride();
+  int width = kl_ + ku_ + 1;
+  S21ForRows(size_, 256, policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *c_row = c_data + i * c_stride;
+      const double *band_row = band_.data() + static_cast<std::size_t>(i) *
+                                                  width;
+      int last = std::min(size_ - 1, i + ku_);
+      for (int k = std::max(0, i - kl_); k <= last; ++k) {
+        double value = band_row[k - i + kl_];
+        if (value == 0.0) continue;
+        const double *b_row = b_data + k * b_stride;
+        for (int j = 0; j < m; ++j) c_row[j] += value * b_row[j];
+      }
+    }
+  });
+  return result;
+}
+
+// Как dgbtrf/dgbtrs: рабочая лента шириной 2 kl + ku + 1, потому что
+// перестановки строк расширяют U до kl + ku наддиагоналей. Множители L
+// хранятся по шагам отдельно и применяются к правой части вместе с
+// перестановками в том же порядке
+S21Matrix S21BandedMatrix::Solve(const S21Matrix &b) const {
+  int n = size_, m = b.GetCols(), kl = kl_, upper = kl_ + ku_;
+  S21CheckRows(n, b);
+  std::size_t width = kl + upper + 1;
+  std::vector<double> work(n * width, 0.0);
+  auto at = [&](int i, int j) -> double & {
+    return work[i * width + (j - i + kl)];
+  };
+  for (int i = 0; i < n; ++i) {
+    int last = std::min(n - 1, i + ku_);
+    for (int j = std::max(0, i - kl); j <= last; ++j) at(i, j) = (*this)(i, j);
+  }
+  std::vector<int> pivots(n);
+  std::vector<double> factors(static_cast<std::size_t>(n) * kl);
+  for (int k = 0; k < n; ++k) {
+    int last_row = std::min(n - 1, k + kl);
+    int last_col = std::min(n - 1, k + upper);
+    int pivot = k;
+    for (int r = k + 1; r <= last_row; ++r) {
+      if (std::fabs(at(r, k)) > std::fabs(at(pivot, k))) pivot = r;
+    }
+    // как в dgbtrf, вырожденность - только точный ноль после выбора
+    // ведущего: любой абсолютный порог отвергал бы мелко масштабированные
+    // системы
+    if (at(pivot, k) == 0.0 || !std::isfinite(at(pivot, k))) {
+      throw std::logic_error("\nDeterminant value can't be equal to 0\n");
+    }
+    pivots[k] = pivot;
+    if (pivot != k) {
+      for (int j = k; j <= last_col; ++j) std::swap(at(k, j), at(pivot, j));
+    }
+    for (int r = k + 1; r <= last_row; ++r) {
+      double factor = at(r, k) / at(k, k);
+      factors[static_cast<std::size_t>(k) * kl + r - k - 1] = factor;
+      if (factor == 0.0) continue;
+      for (int j = k + 1; j <= last_col; ++j) at(r, j) -= factor * at(k, j);
+    }
+  }
+
+  S21Matrix x = b.InLayout(S21Layout::kRowMajor);
+  double *data = x.Data();
+  std::size_t stride = x.Stride();
+  for (int k = 0; k < n; ++k) {
+    double *x_k = data + k * stride;
+    if (pivots[k] != k) {
+      std::swap_ranges(x_k, x_k + m, data + pivots[k] * stride);
+    }
+    int last_row = std::min(n - 1, k + kl);
+    for (int r = k + 1; r <= last_row; ++r) {
+      double factor = factors[static_cast<std::size_t>(k) * kl + r - k - 1];
+      double *x_r = data + r * stride;
+      for (int j = 0; j < m; ++j) x_r[j] -= factor * x_k[j];
+    }
+  }
+  for (int i = n - 1; i >= 0; --i) {
+    double *x_i = data + i * stride;
+    int last_col = std::min(n - 1, i + upper);
+    for (int k = i + 1; k <= last_col; ++k) {
+      double value = at(i, k);
+      const double *x_k = data + k * stride;
+      for (int j = 0; j < m; ++j) x_i[j] -= value * x_k[j];
+    }
+    for (int j = 0; j < m; ++j) x_i[j] /= at(i, i);
+  }
+  return x;
+}
@@ -0,0 +1,85 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_BANDED_MATRIX_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_BANDED_MATRIX_H
+
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Трехдиагональная матрица n x n: три вектора вместо n^2 элементов.
+// lower[i] = a(i + 1, i), diagonal[i] = a(i, i), upper[i] = a(i, i + 1)
+class S21TridiagonalMatrix {
+ public:
+  explicit S21TridiagonalMatrix(int size);
+  S21TridiagonalMatrix(std::vector<double> lower, std::vector<double> diagonal,
+                       std::vector<double> upper);
+  // элементы вне трех диагоналей отбрасываются
+  static S21TridiagonalMatrix FromDense(const S21Matrix &m);
+
+  int GetSize() const { return static_cast<int>(diagonal_.size()); }
+  std::vector<double> &Lower() { return lower_; }
+  std::vector<double> &Diagonal() { return diagonal_; }
+  std::vector<double> &Upper() { return upper_; }
+  const std::vector<double> &Lower() const { return lower_; }
+  const std::vector<double> &Diagonal() const { return diagonal_; }
+  const std::vector<double> &Upper() const { return upper_; }
+
+  // запись только внутри ленты, чтение вне ленты дает 0
+  double &operator()(int row, int col);
+  double operator()(int row, int col) const;
+
+  S21Matrix ToDense() const;
+  // A * B за O(n * m)
+  S21Matrix Multiply(
+      const S21Matrix &b,
+      S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  // A X = B прогонкой (алгоритм Томаса) за O(n * m) без выбора ведущего;
+  // если ведущий элемент близок к нулю, решает ленточным LU с выбором
+  S21Matrix Solve(const S21Matrix &b) const;
+
+ private:
+  std::vector<double> lower_;
+  std::vector<double> diagonal_;
+  std::vector<double> upper_;
+};
+
+// Квадратная ленточная матрица с kl поддиагоналями и ku наддиагоналями.
+// Хранится по строкам: строка i - столбцы [i - kl, i + ku], всего
+// n * (kl + ku + 1) элементов
+class S21BandedMatrix {
+ public:
+  S21BandedMatrix(int size, int lower_bandwidth, int upper_bandwidth);
+  explicit S21BandedMatrix(const S21TridiagonalMatrix &m);
+  // элементы вне ленты отбрасываются
+  static S21BandedMatrix FromDense(const S21Matrix &m, int lower_bandwidth,
+                                   int upper_bandwidth);
+
+  int GetSize() const { return size_; }
+  int GetLowerBandwidth() const { return kl_; }
+  int GetUpperBandwidth() const { return ku_; }
+
+  // запись только внутри ленты, чтение вне ленты дает 0
+  double &operator()(int row, int col);
+  double operator()(int row, int col) const;
+
+  S21Matrix ToDense() const;
+  // A * B за O(n * (kl + ku) * m)
+  S21Matrix Multiply(
+      const S21Matrix &b,
+      S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  // A X = B ленточным LU с частичным выбором ведущего за
+  // O(n * kl * (kl + ku)); верхний множитель расширяется до kl + ku
+  S21Matrix Solve(const S21Matrix &b) const;
+
+ private:
+  int size_;
+  int kl_;
+  int ku_;
+  std::vector<double> band_;
+
+  bool InBand(int row, int col) const {
+    return col - row <= ku_ && row - col <= kl_;
+  }
+  void CheckIndex(int row, int col) const;
+};
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_BANDED_MATRIX_H
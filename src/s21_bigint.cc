@@ -0,0 +1,263 @@
+#include "s21_bigint.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// произведение двух разрядов по 64 бита
+using Wide = unsigned __int128;
+
+const double kBase = 18446744073709551616.0;  // 2^64
+const uint64_t kDecimalChunk = 10000000000000000000ull;  // 10^19
+const int kDecimalChunkDigits = 19;
+
+}  // namespace
+
+S21BigInt::S21BigInt() : negative_(false) {}
+
+S21BigInt::S21BigInt(int64_t value) : negative_(value < 0) {
+  // модуль INT64_MIN не помещается в int64_t
+  uint64_t magnitude = negative_ ? 0 - static_cast<uint64_t>(value)
+                                 : static_cast<uint64_t>(value);
+  if (magnitude) digits_.push_back(magnitude);
+}
+
+S21BigInt S21BigInt::FromDouble(double value) {
+  if (!std::isfinite(value) || std::trunc(value) != value) {
+    throw std::invalid_argument("\nThe value must be an integer\n");
+  }
+  S21BigInt result;
+  result.negative_ = value < 0;
+  double rest = std::fabs(value);
+  // fmod и деление на степень двойки точны, поэтому разряды не теряются
+  while (rest > 0) {
+    double digit = std::fmod(rest, kBase);
+    result.digits_.push_back(static_cast<uint64_t>(digit));
+    rest = (rest - digit) / kBase;
+  }
+  result.Trim();
+  return result;
+}
+
+S21BigInt S21BigInt::operator+(const S21BigInt &other) const {
+  S21BigInt result;
+  if (negative_ == other.negative_) {
+    result.digits_ = AddMagnitude(digits_, other.digits_);
+    result.negative_ = negative_;
+  } else if (CompareMagnitude(digits_, other.digits_) >= 0) {
+    result.digits_ = SubMagnitude(digits_, other.digits_);
+    result.negative_ = negative_;
+  } else {
+    result.digits_ = SubMagnitude(other.digits_, digits_);
+    result.negative_ = other.negative_;
+  }
+  result.Trim();
+  return result;
+}
+
+S21BigInt S21BigInt::operator-(const S21BigInt &other) const {
+  S21BigInt result;
+  if (negative_ != other.negative_) {
+    result.digits_ = AddMagnitude(digits_, other.digits_);
+    result.negative_ = negative_;
+  } else if (CompareMagnitude(digits_, other.digits_) >= 0) {
+    result.digits_ = SubMagnitude(digits_, other.digits_);
+    result.negative_ = negative_;
+  } else {
+    result.digits_ = SubMagnitude(other.digits_, digits_);
+    result.negative_ = !negative_;
+  }
+  result.Trim();
+  return result;
+}
+
+S21BigInt S21BigInt::operator*(const S21BigInt &other) const {
+  S21BigInt result;
+  result.digits_ = MulMagnitude(digits_, other.digits_);
+  result.negative_ = negative_ != other.negative_;
+  result.Trim();
+  return result;
+}
+
+S21BigInt S21BigInt::operator/(const S21BigInt &other) const {
+  if (other.IsZero()) {
+    throw std::invalid_argument("\nDivision by zero\n");
+  }
+  S21BigInt result;
+  result.digits_ = DivMagnitude(digits_, other.digits_);
+  result.negative_ = negative_ != other.negative_;
+  result.Trim();
+  return result;
+}
+
+S21BigInt S21BigInt::operator-() const {
+  S21BigInt result(*this);
+  if (!result.IsZero()) result.negative_ = !negative_;
+  return result;
+}
+
+bool S21BigInt::operator==(const S21BigInt &other) const {
+  return negative_ == other.negative_ && digits_ == other.digits_;
+}
+
+bool S21BigInt::operator!=(const S21BigInt &other) const {
+  return !(*this == other);
+}
+
+bool S21BigInt::IsZero() const { return digits_.empty(); }
+
+int S21BigInt::Sign() const { return IsZero() ? 0 : (negative_ ? -1 : 1); }
+
+std::string S21BigInt::ToString() const {
+  if (IsZero()) return "0";
+  Digits rest = digits_;
+  std::string reversed;
+  while (!rest.empty()) {
+    uint64_t chunk = DivSmall(rest, kDecimalChunk);
+    // у всех кусков, кроме старшего, ведущие нули значимы
+    for (int i = 0; i < kDecimalChunkDigits && (chunk || !rest.empty());
+         ++i) {
+      reversed.push_back(static_cast<char>('0' + chunk % 10));
+      chunk /= 10;
+    }
+  }
+  if (negative_) reversed.push_back('-');
+  return std::string(reversed.rbegin(), reversed.rend());
+}
+
+double S21BigInt::ToDouble() const {
+  double result = 0.0;
+  for (size_t i = digits_.size(); i-- > 0;) {
+    result = result * kBase + static_cast<double>(digits_[i]);
+  }
+  return negative_ ? -result : result;
+}
+
+void S21BigInt::Trim() {
+  while (!digits_.empty() && digits_.back() == 0) digits_.pop_back();
+  if (digits_.empty()) negative_ = false;
+}
+
+int S21BigInt::CompareMagnitude(const Digits &a, const Digits &b) {
+  if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+  for (size_t i = a.size(); i-- > 0;) {
+    if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+S21BigInt::Digits S21BigInt::AddMagnitude(const Digits &a, const Digits &b) {
+  const Digits &longer = a.size() >= b.size() ? a : b;
+  const Digits &shorter = a.size() >= b.size() ? b : a;
+  Digits result(longer.size() + 1);
+  Wide carry = 0;
+  for (size_t i = 0; i < longer.size(); ++i) {
+    Wide sum = carry + longer[i] + (i < shorter.size() ? shorter[i] : 0);
+    result[i] = static_cast<uint64_t>(sum);
+    carry = sum >> 64;
+  }
+  result[longer.size()] = static_cast<uint64_t>(carry);
+  return result;
+}
+
+S21BigInt::Digits S21BigInt::SubMagnitude(const Digits &a, const Digits &b) {
+  Digits result(a.size());
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    uint64_t sub = i < b.size() ? b[i] : 0;
+    result[i] = a[i] - sub - borrow;
+    borrow = (a[i] < sub) || (a[i] - sub < borrow);
+  }
+  return result;
+}
+
+S21BigInt::Digits S21BigInt::MulMagnitude(const Digits &a, const Digits &b) {
+  if (a.empty() || b.empty()) return Digits();
+  Digits result(a.size() + b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    uint64_t carry = 0;
+    Wide a_i = a[i];
+    for (size_t j = 0; j < b.size(); ++j) {
+      Wide cur = a_i * b[j] + result[i + j] + carry;
+      result[i + j] = static_cast<uint64_t>(cur);
+      carry = static_cast<uint64_t>(cur >> 64);
+    }
+    result[i + b.size()] = carry;
+  }
+  return result;
+}
+
+uint64_t S21BigInt::DivSmall(Digits &a, uint64_t divisor) {
+  uint64_t rest = 0;
+  for (size_t i = a.size(); i-- > 0;) {
+    Wide cur = (Wide(rest) << 64) | a[i];
+    a[i] = static_cast<uint64_t>(cur / divisor);
+    rest = static_cast<uint64_t>(cur % divisor);
+  }
+  while (!a.empty() && a.back() == 0) a.pop_back();
+  return rest;
+}
+
+// Деление столбиком, алгоритм D из Кнута (т. 2, 4.3.1)
+S21BigInt::Digits S21BigInt::DivMagnitude(const Digits &a, const Digits &b) {
+  if (CompareMagnitude(a, b) < 0) return Digits();
+  if (b.size() == 1) {
+    Digits quotient(a);
+    DivSmall(quotient, b[0]);
+    return quotient;
+  }
+  size_t m = a.size(), n = b.size();
+  // нормализация: старший разряд делителя должен быть >= 2^63
+  int shift = __builtin_clzll(b[n - 1]);
+  Digits u(m + 1), v(n);
+  for (size_t i = n - 1; i > 0; --i) {
+    v[i] = (b[i] << shift) | (shift ? b[i - 1] >> (64 - shift) : 0);
+  }
+  v[0] = b[0] << shift;
+  u[m] = shift ? a[m - 1] >> (64 - shift) : 0;
+  for (size_t i = m - 1; i > 0; --i) {
+    u[i] = (a[i] << shift) | (shift ? a[i - 1] >> (64 - shift) : 0);
+  }
+  u[0] = a[0] << shift;
+
+  Digits quotient(m - n + 1);
+  for (size_t j = m - n + 1; j-- > 0;) {
+    Wide numerator = (Wide(u[j + n]) << 64) | u[j + n - 1];
+    Wide qhat = numerator / v[n - 1];
+    Wide rhat = numerator % v[n - 1];
+    while ((qhat >> 64) ||
+           qhat * v[n - 2] > ((rhat << 64) | u[j + n - 2])) {
+      --qhat;
+      rhat += v[n - 1];
+      if (rhat >> 64) break;
+    }
+
+    uint64_t carry = 0, borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+      Wide product = qhat * v[i] + carry;
+      carry = static_cast<uint64_t>(product >> 64);
+      uint64_t low = static_cast<uint64_t>(product);
+      uint64_t digit = u[i + j];
+      u[i + j] = digit - low - borrow;
+      borrow = (digit < low) || (digit - low < borrow);
+    }
+    Wide subtrahend = Wide(carry) + borrow;
+    bool negative = u[j + n] < subtrahend;
+    u[j + n] -= static_cast<uint64_t>(subtrahend);
+
+    if (negative) {  // qhat оказалось на единицу больше: добавляем делитель
+      --qhat;
+      Wide sum_carry = 0;
+      for (size_t i = 0; i < n; ++i) {
+        Wide sum = Wide(u[i + j]) + v[i] + sum_carry;
+        u[i + j] = static_cast<uint64_t>(sum);
+        sum_carry = sum >> 64;
+      }
+      u[j + n] += static_cast<uint64_t>(sum_carry);
+    }
+    quotient[j] = static_cast<uint64_t>(qhat);
+  }
+  while (!quotient.empty() && quotient.back() == 0) quotient.pop_back();
+  return quotient;
+}
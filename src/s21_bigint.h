@@ -0,0 +1,44 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_BIGINT_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_BIGINT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Целое произвольной длины для точных вычислений (DeterminantExact).
+// Модуль хранится по основанию 2^64, младшие разряды первыми.
+class S21BigInt {
+ public:
+  S21BigInt();
+  S21BigInt(int64_t value);  // NOLINT: неявное приведение из целого удобно
+  static S21BigInt FromDouble(double value);  // value должно быть целым
+
+  S21BigInt operator+(const S21BigInt &other) const;
+  S21BigInt operator-(const S21BigInt &other) const;
+  S21BigInt operator*(const S21BigInt &other) const;
+  S21BigInt operator/(const S21BigInt &other) const;  // с отсечением к нулю
+  S21BigInt operator-() const;
+  bool operator==(const S21BigInt &other) const;
+  bool operator!=(const S21BigInt &other) const;
+
+  bool IsZero() const;
+  int Sign() const;
+  std::string ToString() const;
+  double ToDouble() const;
+
+ private:
+  using Digits = std::vector<uint64_t>;
+
+  bool negative_;
+  Digits digits_;  // без ведущих нулей, у нуля пусто
+
+  void Trim();
+  static int CompareMagnitude(const Digits &a, const Digits &b);
+  static Digits AddMagnitude(const Digits &a, const Digits &b);
+  static Digits SubMagnitude(const Digits &a, const Digits &b);  // a >= b
+  static Digits MulMagnitude(const Digits &a, const Digits &b);
+  static Digits DivMagnitude(const Digits &a, const Digits &b);
+  static uint64_t DivSmall(Digits &a, uint64_t divisor);  // возвращает остаток
+};
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_BIGINT_H
@@ -0,0 +1,118 @@
+#include "s21_matrix_alloc.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+#include "s21_matrix_pool.h"
+
+namespace {
+
+void *DefaultAllocate(std::size_t bytes, void *) {
+  return ::operator new(bytes);
+}
+
+void DefaultDeallocate(void *ptr, std::size_t, void *) {
+  ::operator delete(ptr);
+}
+
+S21MatrixAllocator allocator = {DefaultAllocate, DefaultDeallocate, nullptr};
+
+std::atomic<uint64_t> allocations{0}, deallocations{0};
+std::atomic<uint64_t> live_bytes{0}, peak_bytes{0}, total_bytes{0};
+std::atomic<uint64_t> op_allocations[S21_STATS_OPS + 1];
+std::atomic<uint64_t> op_bytes[S21_STATS_OPS + 1];
+
+// при S21_MATRIX_MEMPROFILE=1 печатает отчет в stderr при выходе
+struct ExitReport {
+  ~ExitReport() {
+    const char *env = std::getenv("S21_MATRIX_MEMPROFILE");
+    if (env && *env && *env != '0') std::cerr << S21MatrixAllocReport();
+  }
+} exit_report;
+
+}  // namespace
+
+S21MatrixAllocator S21DefaultMatrixAllocator() {
+  return {DefaultAllocate, DefaultDeallocate, nullptr};
+}
+
+void S21SetMatrixAllocator(const S21MatrixAllocator &new_allocator) {
+  if (!new_allocator.allocate || !new_allocator.deallocate) {
+    throw std::invalid_argument("\nAllocator functions must be set\n");
+  }
+  allocator = new_allocator;
+}
+
+void *S21MatrixAllocate(std::size_t bytes) {
+  void *ptr = S21MatrixArena::Allocate(bytes);
+  if (!ptr) ptr = allocator.allocate(bytes, allocator.context);
+  if (!ptr) throw std::bad_alloc();
+
+  int op = static_cast<int>(S21StatsCurrentOp());
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  op_allocations[op].fetch_add(1, std::memory_order_relaxed);
+  op_bytes[op].fetch_add(bytes, std::memory_order_relaxed);
+  uint64_t live =
+      live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  uint64_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+  return ptr;
+}
+
+void S21MatrixDeallocate(void *ptr, std::size_t bytes) {
+  if (!ptr) return;
+  if (!S21MatrixArena::Release(ptr)) {
+    allocator.deallocate(ptr, bytes, allocator.context);
+  }
+  deallocations.fetch_add(1, std::memory_order_relaxed);
+  live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+S21AllocStats S21MatrixAllocStats() {
+  S21AllocStats stats;
+  stats.allocations = allocations.load(std::memory_order_relaxed);
+  stats.deallocations = deallocations.load(std::memory_order_relaxed);
+  stats.live_bytes = live_bytes.load(std::memory_order_relaxed);
+  stats.peak_bytes = peak_bytes.load(std::memory_order_relaxed);
+  stats.total_bytes = total_bytes.load(std::memory_order_relaxed);
+  for (int op = 0; op <= S21_STATS_OPS; ++op) {
+    stats.op_allocations[op] = op_allocations[op].load();
+    stats.op_bytes[op] = op_bytes[op].load();
+  }
+  return stats;
+}
+
+void S21MatrixAllocStatsReset() {
+  allocations = 0;
+  deallocations = 0;
+  total_bytes = 0;
+  peak_bytes = live_bytes.load();
+  for (int op = 0; op <= S21_STATS_OPS; ++op) {
+    op_allocations[op] = 0;
+    op_bytes[op] = 0;
+  }
+}
+
+std::string S21MatrixAllocReport() {
+  S21AllocStats stats = S21MatrixAllocStats();
+  std::ostringstream out;
+  out << "s21_matrix allocations: " << stats.allocations
+      << ", deallocations: " << stats.deallocations
+      << ", live bytes: " << stats.live_bytes
+      << ", peak bytes: " << stats.peak_bytes
+      << ", total bytes: " << stats.total_bytes << "\n";
+  for (int op = 0; op <= S21_STATS_OPS; ++op) {
+    if (stats.op_allocations[op] == 0) continue;
+    out << "  " << S21OpName(static_cast<S21Op>(op)) << ": "
+        << stats.op_allocations[op] << " allocations, " << stats.op_bytes[op]
+        << " bytes\n";
+  }
+  return out.str();
+}
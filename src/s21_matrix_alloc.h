@@ -0,0 +1,46 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_ALLOC_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_ALLOC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "s21_matrix_stats.h"
+
+// Вся память под элементы S21Matrix проходит через S21MatrixAllocate, где
+// считаются живые и пиковые байты и число выделений по операциям. Сами
+// выделения делает активная S21MatrixArena потока, а без нее -
+// подключаемый аллокатор (по умолчанию operator new).
+// Операция определяется по S21_STATS_SCOPE, поэтому разбивка по операциям
+// есть только в сборке с S21_MATRIX_STATS, иначе все попадает в Other.
+
+struct S21MatrixAllocator {
+  void *(*allocate)(std::size_t bytes, void *context);
+  void (*deallocate)(void *ptr, std::size_t bytes, void *context);
+  void *context;
+};
+
+S21MatrixAllocator S21DefaultMatrixAllocator();
+// устанавливать до создания матриц: память освобождается тем аллокатором,
+// который установлен в момент освобождения
+void S21SetMatrixAllocator(const S21MatrixAllocator &allocator);
+
+void *S21MatrixAllocate(std::size_t bytes);
+void S21MatrixDeallocate(void *ptr, std::size_t bytes);
+
+struct S21AllocStats {
+  uint64_t allocations = 0;
+  uint64_t deallocations = 0;
+  uint64_t live_bytes = 0;
+  uint64_t peak_bytes = 0;
+  uint64_t total_bytes = 0;
+  // последний элемент - выделения вне операций (конструкторы, операторы)
+  uint64_t op_allocations[S21_STATS_OPS + 1] = {};
+  uint64_t op_bytes[S21_STATS_OPS + 1] = {};
+};
+
+S21AllocStats S21MatrixAllocStats();
+void S21MatrixAllocStatsReset();  // пик сбрасывается до текущего live_bytes
+std::string S21MatrixAllocReport();
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_ALLOC_H
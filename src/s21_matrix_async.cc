@@ -0,0 +1,111 @@
+#include "s21_matrix_oop.h"
+#include "s21_matrix_pool.h"
+
+namespace {
+
+template <class R, class F>
+std::future<R> RunAsync(F job, const S21CancelToken &token) {
+  auto task =
+      std::make_shared<std::packaged_task<R()>>([job = std::move(job),
+                                                 token]() mutable {
+        S21CancelScope scope(token);
+        S21CheckCancelled();  // отменено, пока задача ждала в очереди
+        return job();
+      });
+  std::future<R> result = task->get_future();
+  S21ThreadPool::Default().Submit([task] { (*task)(); });
+  return result;
+}
+
+template <class R, class F>
+void RunAsync(F job, std::function<void(R, std::exception_ptr)> done,
+              const S21CancelToken &token) {
+  S21ThreadPool::Default().Submit([job = std::move(job), done,
+                                   token]() mutable {
+    R result{};
+    std::exception_ptr error;
+    try {
+      S21CancelScope scope(token);
+      S21CheckCancelled();
+      result = job();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // исключение обработчика некому передать, а из рабочего потока оно
+    // завершило бы программу через std::terminate, поэтому отбрасывается
+    try {
+      done(std::move(result), error);
+    } catch (...) {
+    }
+  });
+}
+
+// Копия операнда для задачи пула. Освобождать ее будет рабочий поток,
+// поэтому память берется мимо арен вызывающего потока и буфер не делится
+// с оригиналом. Дальше копия только перемещается
+S21Matrix Escaping(const S21Matrix &m) {
+  S21MatrixArenaSuspend suspend;
+  S21Matrix copy(m);
+  copy.Data();  // отделяет буфер, общий с m
+  return copy;
+}
+
+}  // namespace
+
+std::future<S21Matrix> S21Matrix::MulMatrixAsync(const S21Matrix &other,
+                                                 S21CancelToken token) const {
+  return RunAsync<S21Matrix>(
+      [a = Escaping(*this), b = Escaping(other)]() mutable {
+        a.MulMatrix(b);
+        return std::move(a);
+      },
+      token);
+}
+
+std::future<S21Matrix> S21Matrix::InverseAsync(S21CancelToken token) const {
+  return RunAsync<S21Matrix>(
+      [a = Escaping(*this)]() mutable { return a.InverseMatrix(); }, token);
+}
+
+std::future<double> S21Matrix::DeterminantAsync(S21CancelToken token) const {
+  return RunAsync<double>(
+      [a = Escaping(*this)]() mutable { return a.Determinant(); }, token);
+}
+
+std::future<S21Matrix> S21Matrix::SolveAsync(const S21Matrix &b,
+                                             S21CancelToken token) const {
+  return RunAsync<S21Matrix>(
+      [a = Escaping(*this), rhs = Escaping(b)]() { return a.Solve(rhs); },
+      token);
+}
+
+void S21Matrix::MulMatrixAsync(const S21Matrix &other, S21MatrixCallback done,
+                               S21CancelToken token) const {
+  RunAsync<S21Matrix>(
+      [a = Escaping(*this), b = Escaping(other)]() mutable {
+        a.MulMatrix(b);
+        return std::move(a);
+      },
+      done, token);
+}
+
+void S21Matrix::InverseAsync(S21MatrixCallback done,
+                             S21CancelToken token) const {
+  RunAsync<S21Matrix>(
+      [a = Escaping(*this)]() mutable { return a.InverseMatrix(); }, done,
+      token);
+}
+
+void S21Matrix::DeterminantAsync(S21DoubleCallback done,
+                                 S21CancelToken token) const {
+  RunAsync<double>(
+      [a = Escaping(*this)]() mutable { return a.Determinant(); }, done,
+      token);
+}
+
+void S21Matrix::SolveAsync(const S21Matrix &b, S21MatrixCallback done,
+                           S21CancelToken token) const {
+  RunAsync<S21Matrix>(
+      [a = Escaping(*this), rhs = Escaping(b)]() { return a.Solve(rhs); },
+      done, token);
+}
@@ -0,0 +1,394 @@
+#include "s21_matrix_blas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <new>
+#include <stdexcept>
+
+#include "s21_matrix_oop.h"
+
+namespace {
+
+// ширина панели в блочных LU, Холецком и треугольном решении
+const int kBlock = 64;
+const S21ExecutionPolicy kPolicy = S21ExecutionPolicy::kPar;
+
+// Матрица в буфере BLAS: элемент (i, j) лежит в p[i * row_step + j * col_step].
+// Транспонирование и переход между раскладками - обмен шагов
+struct Strided {
+  double *p;
+  std::ptrdiff_t row_step;
+  std::ptrdiff_t col_step;
+
+  double &operator()(int i, int j) const {
+    return p[i * row_step + j * col_step];
+  }
+  Strided Block(int i, int j) const {
+    return {&(*this)(i, j), row_step, col_step};
+  }
+  Strided T() const { return {p, col_step, row_step}; }
+  // представление блока rows x cols без копирования, rows и cols > 0
+  S21Matrix View(int rows, int cols) const {
+    if (col_step == 1 && row_step >= cols) {
+      return S21Matrix(p, rows, cols, static_cast<int>(row_step));
+    }
+    return S21Matrix(p, rows, cols, static_cast<int>(col_step),
+                     S21Layout::kColMajor);
+  }
+};
+
+// буферы только читаются, но представления S21Matrix неконстантны
+Strided Wrap(int layout, const double *p, int ld) {
+  double *data = const_cast<double *>(p);
+  if (layout == CblasRowMajor) return {data, ld, 1};
+  return {data, 1, ld};
+}
+
+// Вектор BLAS с шагом inc как столбец: при inc < 0 элементы идут с конца
+Strided Vector(const double *x, int n, int inc) {
+  double *data = const_cast<double *>(x);
+  if (inc < 0) data -= static_cast<std::ptrdiff_t>(n - 1) * inc;
+  return {data, inc, 1};
+}
+
+// при положительном шаге - представление, иначе копия
+S21Matrix Column(Strided v, int n) {
+  if (v.row_step > 0) return v.View(n, 1);
+  S21Matrix column(n, 1);
+  for (int i = 0; i < n; ++i) column(i, 0) = v(i, 0);
+  return column;
+}
+
+void Scatter(const S21Matrix &column, Strided v) {
+  for (int i = 0; i < column.GetRows(); ++i) v(i, 0) = column(i, 0);
+}
+
+int MinLead(int layout, int rows, int cols) {
+  return std::max(1, layout == CblasRowMajor ? cols : rows);
+}
+
+bool ValidLayout(int layout) {
+  return layout == CblasRowMajor || layout == CblasColMajor;
+}
+
+bool ValidTrans(int trans) {
+  return trans == CblasNoTrans || trans == CblasTrans ||
+         trans == CblasConjTrans;
+}
+
+void Xerbla(int parameter, const char *routine) {
+  std::fprintf(stderr, "Parameter %d to routine %s was incorrect\n",
+               parameter, routine);
+}
+
+// при beta == 0 прежнее содержимое не читается, как в BLAS
+void Scale(S21Matrix &c, double beta) {
+  if (beta == 0.0) {
+    c.Apply([](double) { return 0.0; }, kPolicy);
+  } else if (beta != 1.0) {
+    c.MulNumber(beta, kPolicy);
+  }
+}
+
+// Исключения не должны уходить в вызывающий код на C
+template <typename F>
+void GuardBlas(const char *routine, F f) {
+  try {
+    f();
+  } catch (const std::exception &error) {
+    std::fprintf(stderr, "%s: %s\n", routine, error.what());
+  } catch (...) {
+    std::fprintf(stderr, "%s: unknown error\n", routine);
+  }
+}
+
+template <typename F>
+lapack_int GuardLapack(F f) {
+  try {
+    return f();
+  } catch (const std::bad_alloc &) {
+    return LAPACK_WORK_MEMORY_ERROR;
+  } catch (...) {
+    return S21_LAPACK_INTERNAL_ERROR;
+  }
+}
+
+// T X = B для треугольной t порядка n. Диагональный блок решается
+// подстановкой, остаток B обновляется через Gemm
+void SolveTriangular(Strided t, bool lower, bool unit, int n, Strided b,
+                     int nrhs) {
+  auto solve_row = [&](int i, int k_begin, int k_end) {
+    for (int k = k_begin; k < k_end; ++k) {
+      double factor = t(i, k);
+      if (factor == 0.0) continue;
+      for (int j = 0; j < nrhs; ++j) b(i, j) -= factor * b(k, j);
+    }
+    if (!unit) {
+      for (int j = 0; j < nrhs; ++j) b(i, j) /= t(i, i);
+    }
+  };
+  if (lower) {
+    for (int k0 = 0; k0 < n; k0 += kBlock) {
+      int k1 = std::min(n, k0 + kBlock);
+      for (int i = k0; i < k1; ++i) solve_row(i, k0, i);
+      if (k1 == n) break;
+      S21Matrix t21 = t.Block(k1, k0).View(n - k1, k1 - k0);
+      S21Matrix x1 = b.Block(k0, 0).View(k1 - k0, nrhs);
+      S21Matrix b2 = b.Block(k1, 0).View(n - k1, nrhs);
+      S21Matrix::Gemm(-1.0, t21, false, x1, false, 1.0, b2, kPolicy);
+    }
+    return;
+  }
+  for (int k1 = n; k1 > 0; k1 -= kBlock) {
+    int k0 = std::max(0, k1 - kBlock);
+    for (int i = k1 - 1; i >= k0; --i) solve_row(i, i + 1, k1);
+    if (k0 == 0) break;
+    S21Matrix t01 = t.Block(0, k0).View(k0, k1 - k0);
+    S21Matrix x1 = b.Block(k0, 0).View(k1 - k0, nrhs);
+    S21Matrix b0 = b.View(k0, nrhs);
+    S21Matrix::Gemm(-1.0, t01, false, x1, false, 1.0, b0, kPolicy);
+  }
+}
+
+// Блочное LU: панель раскладывается по столбцам с обменом строк на всю
+// ширину, затем U12 = L11^-1 A12 и A22 -= L21 U12 одним Gemm
+lapack_int FactorizeLU(Strided a, int m, int n, lapack_int *ipiv) {
+  lapack_int info = 0;
+  int steps = std::min(m, n);
+  for (int k0 = 0; k0 < steps; k0 += kBlock) {
+    int k1 = std::min(steps, k0 + kBlock);
+    for (int k = k0; k < k1; ++k) {
+      int pivot = k;
+      for (int i = k + 1; i < m; ++i) {
+        if (std::fabs(a(i, k)) > std::fabs(a(pivot, k))) pivot = i;
+      }
+      ipiv[k] = pivot + 1;
+      if (a(pivot, k) == 0.0) {
+        if (info == 0) info = k + 1;
+        continue;
+      }
+      if (pivot != k) {
+        for (int j = 0; j < n; ++j) std::swap(a(k, j), a(pivot, j));
+      }
+      for (int i = k + 1; i < m; ++i) {
+        double factor = a(i, k) /= a(k, k);
+        for (int j = k + 1; j < k1; ++j) a(i, j) -= factor * a(k, j);
+      }
+    }
+    if (k1 == n) continue;
+    SolveTriangular(a.Block(k0, k0), true, true, k1 - k0, a.Block(k0, k1),
+                    n - k1);
+    if (k1 == m) continue;
+    S21Matrix l21 = a.Block(k1, k0).View(m - k1, k1 - k0);
+    S21Matrix u12 = a.Block(k0, k1).View(k1 - k0, n - k1);
+    S21Matrix a22 = a.Block(k1, k1).View(m - k1, n - k1);
+    S21Matrix::Gemm(-1.0, l21, false, u12, false, 1.0, a22, kPolicy);
+  }
+  return info;
+}
+
+// Левосторонний блочный Холецкий A = L L^T по нижнему треугольнику:
+// блочный столбец сначала обновляется уже готовыми столбцами L через Gemm
+// (для диагонального блока - во временную матрицу, чтобы не задеть
+// верхний треугольник), потом раскладывается подстановкой
+lapack_int FactorizeCholesky(Strided a, int n) {
+  for (int j0 = 0; j0 < n; j0 += kBlock) {
+    int j1 = std::min(n, j0 + kBlock);
+    int nb = j1 - j0;
+    if (j0 > 0) {
+      S21Matrix l10 = a.Block(j0, 0).View(nb, j0);
+      S21Matrix update(nb, nb);
+      S21Matrix::Gemm(1.0, l10, false, l10, true, 0.0, update, kPolicy);
+      for (int i = 0; i < nb; ++i) {
+        for (int j = 0; j <= i; ++j) a(j0 + i, j0 + j) -= update(i, j);
+      }
+      if (j1 < n) {
+        S21Matrix l20 = a.Block(j1, 0).View(n - j1, j0);
+        S21Matrix a21 = a.Block(j1, j0).View(n - j1, nb);
+        S21Matrix::Gemm(-1.0, l20, false, l10, true, 1.0, a21, kPolicy);
+      }
+    }
+    for (int j = j0; j < j1; ++j) {
+      double diagonal = a(j, j);
+      for (int k = j0; k < j; ++k) diagonal -= a(j, k) * a(j, k);
+      if (!(diagonal > 0.0)) {
+        a(j, j) = diagonal;
+        return j + 1;
+      }
+      a(j, j) = diagonal = std::sqrt(diagonal);
+      for (int i = j + 1; i < n; ++i) {
+        double sum = a(i, j);
+        for (int k = j0; k < j; ++k) sum -= a(i, k) * a(j, k);
+        a(i, j) = sum / diagonal;
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+void cblas_dgemm(CBLAS_LAYOUT layout, CBLAS_TRANSPOSE trans_a,
+                 CBLAS_TRANSPOSE trans_b, int m, int n, int k, double alpha,
+                 const double *a, int lda, const double *b, int ldb,
+                 double beta, double *c, int ldc) {
+  const char *routine = "cblas_dgemm";
+  bool transpose_a = trans_a != CblasNoTrans;
+  bool transpose_b = trans_b != CblasNoTrans;
+  int bad = 0;
+  if (!ValidLayout(layout)) {
+    bad = 1;
+  } else if (!ValidTrans(trans_a)) {
+    bad = 2;
+  } else if (!ValidTrans(trans_b)) {
+    bad = 3;
+  } else if (m < 0) {
+    bad = 4;
+  } else if (n < 0) {
+    bad = 5;
+  } else if (k < 0) {
+    bad = 6;
+  } else if (lda < (transpose_a ? MinLead(layout, k, m)
+                                 : MinLead(layout, m, k))) {
+    bad = 9;
+  } else if (ldb < (transpose_b ? MinLead(layout, n, k)
+                                 : MinLead(layout, k, n))) {
+    bad = 11;
+  } else if (ldc < MinLead(layout, m, n)) {
+    bad = 14;
+  }
+  if (bad) return Xerbla(bad, routine);
+  if (m == 0 || n == 0) return;
+  GuardBlas(routine, [&] {
+    S21Matrix c_view = Wrap(layout, c, ldc).View(m, n);
+    if (k == 0 || alpha == 0.0) return Scale(c_view, beta);
+    Strided op_a = Wrap(layout, a, lda), op_b = Wrap(layout, b, ldb);
+    if (transpose_a) op_a = op_a.T();
+    if (transpose_b) op_b = op_b.T();
+    S21Matrix::Gemm(alpha, op_a.View(m, k), false, op_b.View(k, n), false,
+                    beta, c_view, kPolicy);
+  });
+}
+
+void cblas_dgemv(CBLAS_LAYOUT layout, CBLAS_TRANSPOSE trans, int m, int n,
+                 double alpha, const double *a, int lda, const double *x,
+                 int inc_x, double beta, double *y, int inc_y) {
+  const char *routine = "cblas_dgemv";
+  int bad = 0;
+  if (!ValidLayout(layout)) {
+    bad = 1;
+  } else if (!ValidTrans(trans)) {
+    bad = 2;
+  } else if (m < 0) {
+    bad = 3;
+  } else if (n < 0) {
+    bad = 4;
+  } else if (lda < MinLead(layout, m, n)) {
+    bad = 7;
+  } else if (inc_x == 0) {
+    bad = 9;
+  } else if (inc_y == 0) {
+    bad = 12;
+  }
+  if (bad) return Xerbla(bad, routine);
+  if (m == 0 || n == 0) return;
+  GuardBlas(routine, [&] {
+    Strided op_a = Wrap(layout, a, lda);
+    if (trans != CblasNoTrans) {
+      op_a = op_a.T();
+      std::swap(m, n);
+    }
+    Strided y_vector = Vector(y, m, inc_y);
+    S21Matrix y_column = Column(y_vector, m);
+    S21Matrix::Gemm(alpha, op_a.View(m, n), false,
+                    Column(Vector(x, n, inc_x), n), false, beta, y_column,
+                    kPolicy);
+    if (inc_y < 0) Scatter(y_column, y_vector);
+  });
+}
+
+void cblas_daxpy(int n, double alpha, const double *x, int inc_x, double *y,
+                 int inc_y) {
+  if (n <= 0 || alpha == 0.0) return;
+  GuardBlas("cblas_daxpy", [&] {
+    S21Matrix x_column = Column(Vector(x, n, inc_x), n);
+    if (inc_y == 0) {
+      *y += alpha * x_column.Sum();
+      return;
+    }
+    Strided y_vector = Vector(y, n, inc_y);
+    S21Matrix y_column = Column(y_vector, n);
+    y_column.Axpy(alpha, x_column, kPolicy);
+    if (inc_y < 0) Scatter(y_column, y_vector);
+  });
+}
+
+void cblas_dscal(int n, double alpha, double *x, int inc_x) {
+  if (n <= 0 || inc_x <= 0) return;
+  GuardBlas("cblas_dscal", [&] {
+    Vector(x, n, inc_x).View(n, 1).MulNumber(alpha, kPolicy);
+  });
+}
+
+lapack_int LAPACKE_dgetrf(int matrix_layout, lapack_int m, lapack_int n,
+                          double *a, lapack_int lda, lapack_int *ipiv) {
+  if (!ValidLayout(matrix_layout)) return -1;
+  if (m < 0) return -2;
+  if (n < 0) return -3;
+  if (lda < MinLead(matrix_layout, m, n)) return -5;
+  if (m == 0 || n == 0) return 0;
+  return GuardLapack([&] {
+    return FactorizeLU(Wrap(matrix_layout, a, lda), m, n, ipiv);
+  });
+}
+
+// A = P L U: A X = B решается как L U X = P^T B,
+// A^T X = B - как U^T L^T (P^T X) = B
+lapack_int LAPACKE_dgetrs(int matrix_layout, char trans, lapack_int n,
+                          lapack_int nrhs, const double *a, lapack_int lda,
+                          const lapack_int *ipiv, double *b, lapack_int ldb) {
+  if (!ValidLayout(matrix_layout)) return -1;
+  bool transpose = trans == 'T' || trans == 't' || trans == 'C' || trans == 'c';
+  if (!transpose && trans != 'N' && trans != 'n') return -2;
+  if (n < 0) return -3;
+  if (nrhs < 0) return -4;
+  if (lda < MinLead(matrix_layout, n, n)) return -6;
+  if (ldb < MinLead(matrix_layout, n, nrhs)) return -9;
+  if (n == 0 || nrhs == 0) return 0;
+  return GuardLapack([&] {
+    Strided lu = Wrap(matrix_layout, a, lda), x = Wrap(matrix_layout, b, ldb);
+    auto swap_rows = [&](int k) {
+      int pivot = ipiv[k] - 1;
+      if (pivot == k) return;
+      for (int j = 0; j < nrhs; ++j) std::swap(x(k, j), x(pivot, j));
+    };
+    if (!transpose) {
+      for (int k = 0; k < n; ++k) swap_rows(k);
+      SolveTriangular(lu, true, true, n, x, nrhs);
+      SolveTriangular(lu, false, false, n, x, nrhs);
+    } else {
+      SolveTriangular(lu.T(), true, false, n, x, nrhs);
+      SolveTriangular(lu.T(), false, true, n, x, nrhs);
+      for (int k = n - 1; k >= 0; --k) swap_rows(k);
+    }
+    return lapack_int(0);
+  });
+}
+
+// Верхний треугольник A - нижний треугольник A^T, поэтому 'U'
+// раскладывается тем же кодом по транспонированному буферу
+lapack_int LAPACKE_dpotrf(int matrix_layout, char uplo, lapack_int n,
+                          double *a, lapack_int lda) {
+  if (!ValidLayout(matrix_layout)) return -1;
+  bool upper = uplo == 'U' || uplo == 'u';
+  if (!upper && uplo != 'L' && uplo != 'l') return -2;
+  if (n < 0) return -3;
+  if (lda < MinLead(matrix_layout, n, n)) return -5;
+  if (n == 0) return 0;
+  return GuardLapack([&] {
+    Strided factor = Wrap(matrix_layout, a, lda);
+    return FactorizeCholesky(upper ? factor.T() : factor, n);
+  });
+}
@@ -0,0 +1,65 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_BLAS_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_BLAS_H
+
+// Подмножество CBLAS и LAPACKE поверх ядер S21Matrix (make blas собирает
+// libs21matrix_blas.a). Имена, константы и порядок аргументов совпадают с
+// cblas.h и lapacke.h, поэтому старый код достаточно перелинковать.
+// Буферы не копируются: матрицы оборачиваются представлениями S21Matrix.
+// Ошибка в аргументах CBLAS печатается в stderr, как делает cblas_xerbla;
+// функции LAPACKE возвращают info по правилам LAPACK.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum CBLAS_LAYOUT {
+  CblasRowMajor = 101,
+  CblasColMajor = 102
+} CBLAS_LAYOUT;
+typedef enum CBLAS_TRANSPOSE {
+  CblasNoTrans = 111,
+  CblasTrans = 112,
+  CblasConjTrans = 113
+} CBLAS_TRANSPOSE;
+typedef CBLAS_LAYOUT CBLAS_ORDER;
+
+#ifndef lapack_int
+#define lapack_int int
+#endif
+#define LAPACK_ROW_MAJOR 101
+#define LAPACK_COL_MAJOR 102
+#define LAPACK_WORK_MEMORY_ERROR -1010
+// любая другая ошибка внутри шима, например отмена операции
+#define S21_LAPACK_INTERNAL_ERROR -1100
+
+// c = alpha * op(a) * op(b) + beta * c
+void cblas_dgemm(CBLAS_LAYOUT layout, CBLAS_TRANSPOSE trans_a,
+                 CBLAS_TRANSPOSE trans_b, int m, int n, int k, double alpha,
+                 const double *a, int lda, const double *b, int ldb,
+                 double beta, double *c, int ldc);
+// y = alpha * op(a) * x + beta * y
+void cblas_dgemv(CBLAS_LAYOUT layout, CBLAS_TRANSPOSE trans, int m, int n,
+                 double alpha, const double *a, int lda, const double *x,
+                 int inc_x, double beta, double *y, int inc_y);
+void cblas_daxpy(int n, double alpha, const double *x, int inc_x, double *y,
+                 int inc_y);  // y += alpha * x
+void cblas_dscal(int n, double alpha, double *x, int inc_x);  // x *= alpha
+
+// PA = LU с частичным выбором ведущего, ipiv нумеруется с 1.
+// info > 0 - номер нулевого элемента на диагонали U
+lapack_int LAPACKE_dgetrf(int matrix_layout, lapack_int m, lapack_int n,
+                          double *a, lapack_int lda, lapack_int *ipiv);
+// решает op(A) X = B по разложению из dgetrf, trans - 'N', 'T' или 'C'
+lapack_int LAPACKE_dgetrs(int matrix_layout, char trans, lapack_int n,
+                          lapack_int nrhs, const double *a, lapack_int lda,
+                          const lapack_int *ipiv, double *b, lapack_int ldb);
+// Холецкий A = L L^T (uplo 'L') или A = U^T U ('U'), второй треугольник
+// не читается и не меняется. info > 0 - порядок неположительного минора
+lapack_int LAPACKE_dpotrf(int matrix_layout, char uplo, lapack_int n,
+                          double *a, lapack_int lda);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_BLAS_H
@@ -0,0 +1,93 @@
+#include "s21_matrix_chain.h"
+
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+S21ProductChain::S21ProductChain(const S21Matrix &first) { Then(first); }
+
+S21ProductChain &S21ProductChain::Then(const S21Matrix &next) {
+  if (!operands_.empty() && operands_.back()->GetCols() != next.GetRows()) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  operands_.push_back(&next);
+  planned_ = false;
+  return *this;
+}
+
+S21ProductChain &S21ProductChain::operator*(const S21Matrix &next) {
+  return Then(next);
+}
+
+int S21ProductChain::GetCount() const {
+  return static_cast<int>(operands_.size());
+}
+
+double S21ProductChain::GetCost() const {
+  Plan();
+  return cost_;
+}
+
+std::string S21ProductChain::GetPlan() const {
+  Plan();
+  return PlanString(0, GetCount() - 1);
+}
+
+S21Matrix S21ProductChain::Evaluate(S21ExecutionPolicy policy) const {
+  Plan();
+  if (GetCount() == 1) return *operands_[0];
+  return Multiply(0, GetCount() - 1, policy);
+}
+
+S21ProductChain::operator S21Matrix() const { return Evaluate(); }
+
+// cost[i][j] = min по k: cost[i][k] + cost[k + 1][j] + p_i * p_k+1 * p_j+1,
+// где A_i имеет размер p_i x p_i+1
+void S21ProductChain::Plan() const {
+  if (planned_) return;
+  int n = GetCount();
+  if (n == 0) throw std::logic_error("\nThe product chain is empty\n");
+  std::vector<double> dims(n + 1);
+  for (int i = 0; i < n; ++i) dims[i] = operands_[i]->GetRows();
+  dims[n] = operands_[n - 1]->GetCols();
+
+  std::vector<double> cost(n * n, 0.0);
+  split_.assign(n * n, 0);
+  for (int length = 2; length <= n; ++length) {
+    for (int i = 0; i + length - 1 < n; ++i) {
+      int j = i + length - 1;
+      double best = std::numeric_limits<double>::infinity();
+      for (int k = i; k < j; ++k) {
+        double candidate = cost[i * n + k] + cost[(k + 1) * n + j] +
+                           dims[i] * dims[k + 1] * dims[j + 1];
+        if (candidate < best) {
+          best = candidate;
+          split_[i * n + j] = k;
+        }
+      }
+      cost[i * n + j] = best;
+    }
+  }
+  cost_ = cost[n - 1];
+  planned_ = true;
+}
+
+std::string S21ProductChain::PlanString(int i, int j) const {
+  if (i == j) return "A" + std::to_string(i);
+  int k = split_[i * GetCount() + j];
+  return "(" + PlanString(i, k) + " " + PlanString(k + 1, j) + ")";
+}
+
+// промежуточные произведения живут только до следующего умножения
+S21Matrix S21ProductChain::Multiply(int i, int j,
+                                    S21ExecutionPolicy policy) const {
+  int k = split_[i * GetCount() + j];
+  std::optional<S21Matrix> left, right;
+  if (i != k) left.emplace(Multiply(i, k, policy));
+  if (k + 1 != j) right.emplace(Multiply(k + 1, j, policy));
+  const S21Matrix &a = left ? *left : *operands_[i];
+  const S21Matrix &b = right ? *right : *operands_[j];
+  S21Matrix result(a.GetRows(), b.GetCols());
+  S21Matrix::Gemm(1.0, a, false, b, false, 0.0, result, policy);
+  return result;
+}
@@ -0,0 +1,44 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_CHAIN_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_CHAIN_H
+
+#include <string>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+// Отложенное произведение A0 * A1 * ... * An-1. Множители только
+// запоминаются, а при вычислении порядок умножений выбирается динамическим
+// программированием по размерам (задача о цепочке матриц, O(n^3)).
+// Хранит ссылки: множители должны жить до вычисления, поэтому цепочку
+// удобно строить и вычислять в одном выражении:
+//   S21Matrix r = S21ProductChain(a) * b * c * d;
+class S21ProductChain {
+ public:
+  S21ProductChain() = default;
+  explicit S21ProductChain(const S21Matrix &first);
+
+  S21ProductChain &Then(const S21Matrix &next);
+  S21ProductChain &operator*(const S21Matrix &next);
+
+  int GetCount() const;
+  // число умножений скаляров при оптимальной расстановке скобок
+  double GetCost() const;
+  // расстановка скобок, например "((A0 A1) A2)"
+  std::string GetPlan() const;
+
+  S21Matrix Evaluate(
+      S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  operator S21Matrix() const;  // неявное вычисление при присваивании
+
+ private:
+  std::vector<const S21Matrix *> operands_;
+  mutable std::vector<int> split_;  // split_[i * n + j] - последний в левой
+  mutable double cost_ = 0.0;
+  mutable bool planned_ = false;
+
+  void Plan() const;
+  std::string PlanString(int i, int j) const;
+  S21Matrix Multiply(int i, int j, S21ExecutionPolicy policy) const;
+};
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_CHAIN_H
@@ -0,0 +1,167 @@
+#include "s21_matrix_inverse.h"
+
+#include <vector>
+
+S21MatrixInverse::S21MatrixInverse(const S21Matrix &matrix,
+                                   int refactor_interval)
+    : matrix_(matrix), updates_(0), refactor_interval_(refactor_interval) {
+  matrix_.Materialize();             // строки читаются напрямую
+  matrix_.EnableCopyOnWrite(false);  // элементы меняются напрямую
+  if (matrix.rows_ != matrix.cols_) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  } else if (refactor_interval < 1) {
+    throw std::invalid_argument("\nRefactor interval must be positive\n");
+  }
+  Refactor();
+}
+
+const S21Matrix &S21MatrixInverse::Matrix() const { return matrix_; }
+
+const S21Matrix &S21MatrixInverse::Inverse() const { return inverse_; }
+
+int S21MatrixInverse::GetUpdateCount() const { return updates_; }
+
+int S21MatrixInverse::GetRefactorInterval() const {
+  return refactor_interval_;
+}
+
+void S21MatrixInverse::SetRefactorInterval(int refactor_interval) {
+  if (refactor_interval < 1) {
+    throw std::invalid_argument("\nRefactor interval must be positive\n");
+  }
+  refactor_interval_ = refactor_interval;
+  if (updates_ >= refactor_interval_) Refactor();
+}
+
+void S21MatrixInverse::Refactor() {
+  inverse_ = matrix_.Solve(S21Matrix::Identity(matrix_.rows_));
+  updates_ = 0;
+}
+
+// транспонированные аргументы приводятся к обычному буферу: формулы ниже
+// читают строки напрямую
+void S21MatrixInverse::UpdateRank1(const S21Matrix &u_arg,
+                                   const S21Matrix &v_arg) {
+  S21Matrix u_storage, v_storage;
+  const S21Matrix &u = S21Matrix::RowMajor(u_arg, u_storage);
+  const S21Matrix &v = S21Matrix::RowMajor(v_arg, v_storage);
+  int n = matrix_.rows_;
+  if (u.rows_ != n || v.rows_ != n || u.cols_ != 1 || v.cols_ != 1) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  std::vector<double> inv_u(n, 0.0), v_inv(n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      inv_u[i] += inverse_.matrix_[i][j] * u.matrix_[j][0];
+      v_inv[j] += v.matrix_[i][0] * inverse_.matrix_[i][j];
+    }
+  }
+  double denom = 1.0;
+  for (int i = 0; i < n; ++i) denom += v.matrix_[i][0] * inv_u[i];
+
+  ApplyRank1(inv_u.data(), v_inv.data(), denom);
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      matrix_.matrix_[i][j] += u.matrix_[i][0] * v.matrix_[j][0];
+    }
+  }
+  CountUpdate();
+}
+
+// A^-1 - A^-1 U (I + V^T A^-1 U)^-1 V^T A^-1
+void S21MatrixInverse::UpdateRankK(const S21Matrix &u_arg,
+                                   const S21Matrix &v_arg) {
+  S21Matrix u_storage, v_storage;
+  const S21Matrix &u = S21Matrix::RowMajor(u_arg, u_storage);
+  const S21Matrix &v = S21Matrix::RowMajor(v_arg, v_storage);
+  int n = matrix_.rows_, k = u.cols_;
+  if (u.rows_ != n || v.rows_ != n || v.cols_ != k) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  S21Matrix inv_u(n, k), v_inv(k, n);
+  S21Matrix::MulInto(inverse_, u, inv_u);
+  S21Matrix::Gemm(1.0, v, true, inverse_, false, 0.0, v_inv);
+
+  S21Matrix capacitance = S21Matrix::Identity(k);
+  S21Matrix::Gemm(1.0, v, true, inv_u, false, 1.0, capacitance);
+  S21Matrix w = capacitance.Solve(v_inv);  // k x n
+
+  for (int i = 0; i < n; ++i) {
+    for (int l = 0; l < k; ++l) {
+      double y = inv_u.matrix_[i][l];
+      double u_il = u.matrix_[i][l];
+      for (int j = 0; j < n; ++j) {
+        inverse_.matrix_[i][j] -= y * w.matrix_[l][j];
+        matrix_.matrix_[i][j] += u_il * v.matrix_[j][l];
+      }
+    }
+  }
+  CountUpdate();
+}
+
+// u = e_row, v = новая строка - старая: A^-1 u - это столбец row обратной
+void S21MatrixInverse::UpdateRow(int row, const S21Matrix &values_arg) {
+  S21Matrix values_storage;
+  const S21Matrix &values = S21Matrix::RowMajor(values_arg, values_storage);
+  int n = matrix_.rows_;
+  if (row < 0 || row >= n) {
+    throw std::out_of_range("Index outside the matrix");
+  } else if (values.rows_ != 1 || values.cols_ != n) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  std::vector<double> inv_u(n), delta(n), v_inv(n, 0.0);
+  for (int i = 0; i < n; ++i) {
+    inv_u[i] = inverse_.matrix_[i][row];
+    delta[i] = values.matrix_[0][i] - matrix_.matrix_[row][i];
+  }
+  for (int i = 0; i < n; ++i) {
+    if (delta[i] == 0.0) continue;
+    for (int j = 0; j < n; ++j) v_inv[j] += delta[i] * inverse_.matrix_[i][j];
+  }
+  double denom = 1.0;
+  for (int i = 0; i < n; ++i) denom += delta[i] * inv_u[i];
+
+  ApplyRank1(inv_u.data(), v_inv.data(), denom);
+  for (int j = 0; j < n; ++j) matrix_.matrix_[row][j] = values.matrix_[0][j];
+  CountUpdate();
+}
+
+// u = новый столбец - старый, v = e_col: v^T A^-1 - это строка col обратной
+void S21MatrixInverse::UpdateColumn(int col, const S21Matrix &values_arg) {
+  S21Matrix values_storage;
+  const S21Matrix &values = S21Matrix::RowMajor(values_arg, values_storage);
+  int n = matrix_.rows_;
+  if (col < 0 || col >= n) {
+    throw std::out_of_range("Index outside the matrix");
+  } else if (values.rows_ != n || values.cols_ != 1) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  std::vector<double> inv_u(n, 0.0), v_inv(n);
+  for (int i = 0; i < n; ++i) {
+    double delta = values.matrix_[i][0] - matrix_.matrix_[i][col];
+    if (delta == 0.0) continue;
+    for (int j = 0; j < n; ++j) inv_u[j] += inverse_.matrix_[j][i] * delta;
+  }
+  for (int j = 0; j < n; ++j) v_inv[j] = inverse_.matrix_[col][j];
+
+  ApplyRank1(inv_u.data(), v_inv.data(), 1.0 + inv_u[col]);
+  for (int i = 0; i < n; ++i) matrix_.matrix_[i][col] = values.matrix_[i][0];
+  CountUpdate();
+}
+
+void S21MatrixInverse::ApplyRank1(const double *inv_u, const double *v_inv,
+                                  double denom) {
+  if (std::fabs(denom) < EPS) {
+    throw std::logic_error("\nDeterminant value can't be equal to 0\n");
+  }
+  int n = inverse_.rows_;
+  for (int i = 0; i < n; ++i) {
+    double factor = inv_u[i] / denom;
+    if (factor == 0.0) continue;
+    for (int j = 0; j < n; ++j) inverse_.matrix_[i][j] -= factor * v_inv[j];
+  }
+}
+
+void S21MatrixInverse::CountUpdate() {
+  if (++updates_ >= refactor_interval_) Refactor();
+}
@@ -0,0 +1,44 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_INVERSE_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_INVERSE_H
+
+#include "s21_matrix_oop.h"
+
+#define S21_REFACTOR_INTERVAL 32
+
+// Матрица вместе с закешированной обратной. Малоранговые изменения матрицы
+// пересчитывают обратную по формулам Шермана-Моррисона-Вудбери за O(n^2 k),
+// а после refactor_interval обновлений обратная считается заново, чтобы
+// ошибка округления не накапливалась.
+class S21MatrixInverse {
+ public:
+  explicit S21MatrixInverse(const S21Matrix &matrix,
+                            int refactor_interval = S21_REFACTOR_INTERVAL);
+
+  const S21Matrix &Matrix() const;
+  const S21Matrix &Inverse() const;
+
+  // A += u * v^T, где u и v - столбцы n x 1
+  void UpdateRank1(const S21Matrix &u, const S21Matrix &v);
+  // A += U * V^T, где U и V - матрицы n x k
+  void UpdateRankK(const S21Matrix &u, const S21Matrix &v);
+  // замена строки (1 x n) или столбца (n x 1) матрицы
+  void UpdateRow(int row, const S21Matrix &values);
+  void UpdateColumn(int col, const S21Matrix &values);
+
+  void Refactor();  // полный пересчет обратной
+  int GetUpdateCount() const;  // обновлений с последнего пересчета
+  int GetRefactorInterval() const;
+  void SetRefactorInterval(int refactor_interval);
+
+ private:
+  S21Matrix matrix_;
+  S21Matrix inverse_;
+  int updates_;
+  int refactor_interval_;
+
+  // обратная для A + u * v^T, где inv_u = A^-1 u, v_inv = v^T A^-1
+  void ApplyRank1(const double *inv_u, const double *v_inv, double denom);
+  void CountUpdate();
+};
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_INVERSE_H
@@ -0,0 +1,30 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_KERNELS_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_KERNELS_H
+
+// Общие помощники ядер структурированных матриц (ленточных, упакованных).
+// Внутренний заголовок: в тесты и пользовательский код не включается
+
+#include <functional>
+#include <stdexcept>
+
+#include "s21_matrix_oop.h"
+
+// body(r0, r1) для блоков строк результата: целиком в вызывающем потоке
+// при kSeq, иначе кусками не меньше grain строк в пуле
+inline void S21ForRows(int rows, int grain, S21ExecutionPolicy policy,
+                       const std::function<void(int, int)> &body) {
+  if (policy == S21ExecutionPolicy::kSeq) {
+    body(0, rows);
+  } else {
+    S21ParallelFor(0, rows, grain, body);
+  }
+}
+
+// у правой части столько же строк, сколько у квадратной матрицы порядка size
+inline void S21CheckRows(int size, const S21Matrix &b) {
+  if (b.GetRows() != size) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+}
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_KERNELS_H
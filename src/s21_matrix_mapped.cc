@@ -0,0 +1,297 @@
+#include "s21_matrix_mapped.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "s21_matrix_pool.h"
+
+namespace {
+
+const char kMagic[4] = {'S', '2', '1', 'M'};
+const std::size_t kHeaderBytes = 16;
+
+struct Header {
+  char magic[4];
+  std::int32_t rows;
+  std::int32_t cols;
+  std::int32_t reserved;
+};
+static_assert(sizeof(Header) == kHeaderBytes, "header must be 16 bytes");
+
+// размер данных rows x cols вместе с заголовком помещается в size_t;
+// иначе произведение переполнится и пройдет любую проверку размера
+bool FitsInMemory(int rows, int cols) {
+  return static_cast<std::size_t>(rows) <=
+         (SIZE_MAX - kHeaderBytes) / sizeof(double) / cols;
+}
+
+[[noreturn]] void ThrowSystemError(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), "\n" + what + "\n");
+}
+
+// закрывает дескриптор и при ошибке конструктора
+class FileDescriptor {
+ public:
+  FileDescriptor(const std::string &path, int flags)
+      : fd_(::open(path.c_str(), flags, 0644)) {
+    if (fd_ < 0) ThrowSystemError("Can't open " + path);
+  }
+  ~FileDescriptor() { ::close(fd_); }
+  FileDescriptor(const FileDescriptor &) = delete;
+  FileDescriptor &operator=(const FileDescriptor &) = delete;
+  int Get() const { return fd_; }
+
+ private:
+  int fd_;
+};
+
+}  // namespace
+
+S21FileMapping::S21FileMapping(const std::string &path, bool writable)
+    : writable_(writable) {
+  FileDescriptor fd(path, writable ? O_RDWR : O_RDONLY);
+  Map(fd.Get(), path);
+}
+
+S21FileMapping S21FileMapping::Create(const std::string &path,
+                                      std::size_t bytes) {
+  FileDescriptor fd(path, O_RDWR | O_CREAT | O_TRUNC);
+  if (::ftruncate(fd.Get(), static_cast<off_t>(bytes)) != 0) {
+    ThrowSystemError("Can't resize " + path);
+  }
+  S21FileMapping result;
+  result.writable_ = true;
+  result.Map(fd.Get(), path);
+  return result;
+}
+
+S21FileMapping::S21FileMapping(S21FileMapping &&other)
+    : data_(other.data_), size_(other.size_), writable_(other.writable_) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+S21FileMapping &S21FileMapping::operator=(S21FileMapping &&other) {
+  if (this != &other) {
+    Unmap();
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    writable_ = other.writable_;
+  }
+  return *this;
+}
+
+S21FileMapping::~S21FileMapping() { Unmap(); }
+
+// Отображение переживает закрытие дескриптора. Пустой файл не
+// отображается: mmap нулевой длины - ошибка. Файл, открытый на чтение,
+// отображается MAP_PRIVATE с правом записи: запись в такую память не
+// падает, а копирует страницу и в файл не попадает
+void S21FileMapping::Map(int fd, const std::string &path) {
+  struct stat info;
+  if (::fstat(fd, &info) != 0) ThrowSystemError("Can't stat " + path);
+  size_ = static_cast<std::size_t>(info.st_size);
+  if (size_ == 0) return;
+  void *data = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                      writable_ ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    size_ = 0;
+    ThrowSystemError("Can't map " + path);
+  }
+  data_ = static_cast<char *>(data);
+}
+
+void S21FileMapping::Unmap() {
+  if (data_) ::munmap(data_, size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+// madvise - только подсказка, поэтому ошибки не важны. Начало выравнивается
+// вниз до страницы, как требует madvise
+void S21FileMapping::Prefetch(std::size_t offset, std::size_t bytes) const {
+  if (!data_ || offset >= size_) return;
+  static const std::size_t page = ::sysconf(_SC_PAGESIZE);
+  std::size_t begin = offset / page * page;
+  std::size_t end = std::min(size_, offset + bytes);
+  ::madvise(data_ + begin, end - begin, MADV_WILLNEED);
+}
+
+void S21FileMapping::Flush() const {
+  if (data_ && writable_ && ::msync(data_, size_, MS_SYNC) != 0) {
+    ThrowSystemError("Can't flush mapped file");
+  }
+}
+
+S21MappedMatrix S21MappedMatrix::Create(const std::string &path, int rows,
+                                        int cols) {
+  if (rows <= 0 || cols <= 0 || !FitsInMemory(rows, cols)) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  S21MappedMatrix result;
+  std::size_t bytes = kHeaderBytes + static_cast<std::size_t>(rows) * cols *
+                                         sizeof(double);
+  result.mapping_ = S21FileMapping::Create(path, bytes);
+  Header header{{kMagic[0], kMagic[1], kMagic[2], kMagic[3]}, rows, cols, 0};
+  std::memcpy(result.mapping_.Data(), &header, sizeof(header));
+  result.rows_ = rows;
+  result.cols_ = cols;
+  return result;
+}
+
+S21MappedMatrix S21MappedMatrix::Open(const std::string &path,
+                                      bool writable) {
+  S21MappedMatrix result;
+  result.mapping_ = S21FileMapping(path, writable);
+  result.ReadHeader();
+  return result;
+}
+
+S21MappedMatrix S21MappedMatrix::Save(const std::string &path,
+                                      const S21Matrix &m) {
+  S21MappedMatrix result = Create(path, m.GetRows(), m.GetCols());
+  S21Matrix all = result.Tile(0, 0, result.rows_, result.cols_);
+  all.ZipWith(m, [](double, double y) { return y; });
+  return result;
+}
+
+void S21MappedMatrix::ReadHeader() {
+  Header header;
+  if (mapping_.Size() < kHeaderBytes) {
+    throw std::invalid_argument("\nWrong matrix file\n");
+  }
+  std::memcpy(&header, mapping_.Data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.rows <= 0 || header.cols <= 0 ||
+      !FitsInMemory(header.rows, header.cols) ||
+      mapping_.Size() < kHeaderBytes + static_cast<std::size_t>(header.rows) *
+                                           header.cols * sizeof(double)) {
+    throw std::invalid_argument("\nWrong matrix file\n");
+  }
+  rows_ = header.rows;
+  cols_ = header.cols;
+}
+
+double *S21MappedMatrix::Elements() const {
+  return reinterpret_cast<double *>(mapping_.Data() + kHeaderBytes);
+}
+
+S21Matrix S21MappedMatrix::Tile(int row, int col, int rows, int cols) const {
+  if (row < 0 || col < 0 || rows <= 0 || cols <= 0 || row + rows > rows_ ||
+      col + cols > cols_) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  return S21Matrix(Elements() + static_cast<std::size_t>(row) * cols_ + col,
+                   rows, cols, cols_);
+}
+
+S21Matrix S21MappedMatrix::Load() const {
+  S21Matrix all = Tile(0, 0, rows_, cols_);
+  return S21Matrix(all);  // копия представления - обычная матрица
+}
+
+void S21MappedMatrix::PrefetchRows(int row, int rows) const {
+  std::size_t row_bytes = static_cast<std::size_t>(cols_) * sizeof(double);
+  mapping_.Prefetch(kHeaderBytes + row * row_bytes, rows * row_bytes);
+}
+
+// Строки плитки лежат в файле не подряд, поэтому подсказка дается по
+// отрезку каждой строки; у плитки во всю ширину это одна полоса
+void S21MappedMatrix::PrefetchTile(int row, int col, int rows,
+                                   int cols) const {
+  if (col == 0 && cols == cols_) return PrefetchRows(row, rows);
+  std::size_t row_bytes = static_cast<std::size_t>(cols_) * sizeof(double);
+  for (int i = row; i < row + rows; ++i) {
+    mapping_.Prefetch(kHeaderBytes + i * row_bytes + col * sizeof(double),
+                      cols * sizeof(double));
+  }
+}
+
+// Шесть квадратных плиток double: A и B в двух экземплярах, две плитки C
+int S21OutOfCoreTile(std::size_t memory_budget) {
+  int tile = static_cast<int>(
+      std::sqrt(static_cast<double>(memory_budget / (6 * sizeof(double)))));
+  if (tile < 1) throw std::invalid_argument("\nMemory budget is too small\n");
+  return tile;
+}
+
+// Шаги конвейера идут в порядке (плитка C по строкам, затем по k). На шаге
+// s умножаются плитки, загруженные на шаге s - 1, пока задача пула читает
+// плитки шага s + 1; готовая плитка C пишется в файл, пока копится следующая
+void S21MultiplyOutOfCore(const S21MappedMatrix &a, const S21MappedMatrix &b,
+                          S21MappedMatrix &c, std::size_t memory_budget,
+                          S21ExecutionPolicy policy) {
+  int m = a.GetRows(), inner = a.GetCols(), n = b.GetCols();
+  if (b.GetRows() != inner || c.GetRows() != m || c.GetCols() != n) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  int tile = S21OutOfCoreTile(memory_budget);
+  long long tiles_m = (m + tile - 1) / tile, tiles_n = (n + tile - 1) / tile,
+            tiles_k = (inner + tile - 1) / tile;
+  long long steps = tiles_m * tiles_n * tiles_k;
+  struct Step {
+    int row, col, k, rows, cols, depth;
+    bool last;
+  };
+  auto step = [&](long long s) {
+    int k = static_cast<int>(s % tiles_k) * tile;
+    int col = static_cast<int>(s / tiles_k % tiles_n) * tile;
+    int row = static_cast<int>(s / (tiles_k * tiles_n)) * tile;
+    return Step{row,
+                col,
+                k,
+                std::min(tile, m - row),
+                std::min(tile, n - col),
+                std::min(tile, inner - k),
+                k + tile >= inner};
+  };
+
+  S21Matrix a_tiles[2], b_tiles[2], c_tiles[2];
+  auto load = [&](long long s) {
+    Step t = step(s);
+    a.PrefetchTile(t.row, t.k, t.rows, t.depth);
+    b.PrefetchTile(t.k, t.col, t.depth, t.cols);
+    // первую плитку грузит вызывающий поток, а заменяет рабочий: память
+    // берется мимо арен, иначе рабочий освобождал бы блок чужой арены
+    S21MatrixArenaSuspend suspend;
+    // копия представления читает страницы файла в этом потоке
+    S21Matrix a_view = a.Tile(t.row, t.k, t.rows, t.depth);
+    S21Matrix b_view = b.Tile(t.k, t.col, t.depth, t.cols);
+    a_tiles[s % 2] = S21Matrix(a_view);
+    b_tiles[s % 2] = S21Matrix(b_view);
+  };
+  // группы объявлены после буферов и при исключении дожидаются своих задач
+  // раньше, чем буферы будут разрушены
+  S21TaskGroup loader, writer;
+  int current = 0;
+  load(0);
+  for (long long s = 0; s < steps; ++s) {
+    loader.Wait();
+    if (s + 1 < steps) loader.Run([&load, s] { load(s + 1); });
+    Step t = step(s);
+    S21Matrix &acc = c_tiles[current];
+    if (acc.GetRows() != t.rows || acc.GetCols() != t.cols) {
+      acc = S21Matrix(t.rows, t.cols);
+    }
+    S21Matrix::Gemm(1.0, a_tiles[s % 2], false, b_tiles[s % 2], false,
+                    t.k == 0 ? 0.0 : 1.0, acc, policy);
+    if (!t.last) continue;
+    writer.Wait();
+    writer.Run([&c, &acc, t] {
+      S21Matrix target = c.Tile(t.row, t.col, t.rows, t.cols);
+      target.ZipWith(acc, [](double, double y) { return y; });
+    });
+    current ^= 1;
+  }
+  writer.Wait();
+}
@@ -0,0 +1,84 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_MAPPED_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_MAPPED_H
+
+#include <cstddef>
+#include <string>
+
+#include "s21_matrix_oop.h"
+
+// Файл, целиком отображенный в память (mmap). Ошибки ОС бросаются как
+// std::system_error
+class S21FileMapping {
+ public:
+  S21FileMapping() = default;
+  // отображает существующий файл; writable - изменения пишутся в файл,
+  // иначе остаются в частных копиях страниц этого отображения
+  explicit S21FileMapping(const std::string &path, bool writable = false);
+  // создает или обрезает файл до bytes байт (новые байты - нули)
+  static S21FileMapping Create(const std::string &path, std::size_t bytes);
+  S21FileMapping(S21FileMapping &&other);
+  S21FileMapping &operator=(S21FileMapping &&other);
+  S21FileMapping(const S21FileMapping &) = delete;
+  S21FileMapping &operator=(const S21FileMapping &) = delete;
+  ~S21FileMapping();
+
+  char *Data() const { return data_; }
+  std::size_t Size() const { return size_; }
+  bool IsWritable() const { return writable_; }
+  // просит ядро заранее прочитать диапазон (madvise WILLNEED), не ждет
+  void Prefetch(std::size_t offset, std::size_t bytes) const;
+  void Flush() const;  // синхронно сбрасывает изменения на диск
+
+ private:
+  char *data_ = nullptr;
+  std::size_t size_ = 0;
+  bool writable_ = false;
+
+  void Map(int fd, const std::string &path);
+  void Unmap();
+};
+
+// Матрица в двоичном файле: 16 байт заголовка ("S21M", строки, столбцы)
+// и элементы double по строкам. Плитки доступны представлениями S21Matrix
+// без копирования, страницы читаются с диска при первом обращении
+class S21MappedMatrix {
+ public:
+  S21MappedMatrix() = default;
+  static S21MappedMatrix Create(const std::string &path, int rows, int cols);
+  static S21MappedMatrix Open(const std::string &path, bool writable = false);
+  static S21MappedMatrix Save(const std::string &path, const S21Matrix &m);
+
+  int GetRows() const { return rows_; }
+  int GetCols() const { return cols_; }
+  // Представление плитки; для файла, открытого на чтение, запись в нее
+  // видна только этому отображению и в файл не попадает
+  S21Matrix Tile(int row, int col, int rows, int cols) const;
+  S21Matrix Load() const;  // копия всей матрицы в памяти
+  void PrefetchRows(int row, int rows) const;
+  // только отрезки [col, col + cols) строк плитки, без остальной полосы
+  void PrefetchTile(int row, int col, int rows, int cols) const;
+  void Flush() const { mapping_.Flush(); }
+
+ private:
+  S21FileMapping mapping_;
+  int rows_ = 0;
+  int cols_ = 0;
+
+  double *Elements() const;
+  void ReadHeader();
+};
+
+// C = A * B для матриц в файлах, не помещающихся в память. C должна быть
+// открыта на запись и иметь размер результата. Плитки выбираются так,
+// чтобы в памяти одновременно было не больше memory_budget байт: по две
+// плитки A и B (текущая и загружаемая заранее) и две плитки C (копится и
+// пишется в файл). Чтение следующих плиток и запись готовой плитки C идут
+// задачами пула параллельно с умножением текущих
+void S21MultiplyOutOfCore(
+    const S21MappedMatrix &a, const S21MappedMatrix &b, S21MappedMatrix &c,
+    std::size_t memory_budget,
+    S21ExecutionPolicy policy = S21ExecutionPolicy::kPar);
+// сторона квадратной плитки, которую выберет S21MultiplyOutOfCore
+int S21OutOfCoreTile(std::size_t memory_budget);
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_MAPPED_H
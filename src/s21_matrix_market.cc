@@ -0,0 +1,338 @@
+#include "s21_matrix_market.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include "s21_matrix_mapped.h"
+#include "s21_thread_pool.h"
+
+namespace {
+
+// на кусок не меньше 64 КБ текста, чтобы задачи не были слишком мелкими
+const std::size_t kChunkBytes = 1 << 16;
+
+enum class Format { kCoordinate, kArray };
+enum class Field { kReal, kInteger, kPattern };
+enum class Symmetry { kGeneral, kSymmetric, kSkew };
+
+// Содержимое файла до раскрытия симметрии: тройки с индексами от 0 для
+// coordinate или значения по столбцам для array
+struct Market {
+  Format format;
+  Field field;
+  Symmetry symmetry;
+  int rows;
+  int cols;
+  std::vector<S21Triplet> triplets;
+  std::vector<double> values;
+};
+
+[[noreturn]] void ThrowFormat(const char *what = "Wrong Matrix Market file") {
+  throw std::invalid_argument(std::string("\n") + what + "\n");
+}
+
+bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char *SkipBlanks(const char *p, const char *end) {
+  while (p < end && IsBlank(*p)) ++p;
+  return p;
+}
+
+const char *NextLine(const char *p, const char *end) {
+  const void *newline = std::memchr(p, '\n', end - p);
+  return newline ? static_cast<const char *>(newline) + 1 : end;
+}
+
+std::string Lower(std::string word) {
+  std::transform(word.begin(), word.end(), word.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return word;
+}
+
+// слова первой строки: %%MatrixMarket matrix формат поле симметрия
+std::vector<std::string> Words(const char *p, const char *end) {
+  std::vector<std::string> words;
+  while (true) {
+    p = SkipBlanks(p, end);
+    if (p == end || *p == '\n') return words;
+    const char *word = p;
+    while (p < end && !IsBlank(*p) && *p != '\n') ++p;
+    words.push_back(Lower(std::string(word, p)));
+  }
+}
+
+template <typename T>
+bool ParseNumber(const char *&p, const char *end, T &value) {
+  p = SkipBlanks(p, end);
+  if (p < end && *p == '+') ++p;  // from_chars не принимает знак плюс
+  std::from_chars_result result = std::from_chars(p, end, value);
+  if (result.ec != std::errc() ||
+      (result.ptr < end && !IsBlank(*result.ptr) && *result.ptr != '\n')) {
+    return false;
+  }
+  p = result.ptr;
+  return true;
+}
+
+// Кусок текста - целые строки данных; пустые строки и комментарии
+// пропускаются
+void ParseChunk(const char *p, const char *end, const Market &market,
+                std::vector<S21Triplet> &triplets,
+                std::vector<double> &values) {
+  while (p < end) {
+    p = SkipBlanks(p, end);
+    if (p == end) break;
+    if (*p == '\n' || *p == '%') {
+      p = NextLine(p, end);
+      continue;
+    }
+    if (market.format == Format::kArray) {
+      double value;
+      if (!ParseNumber(p, end, value)) ThrowFormat();
+      values.push_back(value);
+    } else {
+      long long row, col;
+      double value = 1.0;
+      if (!ParseNumber(p, end, row) || !ParseNumber(p, end, col) ||
+          (market.field != Field::kPattern && !ParseNumber(p, end, value))) {
+        ThrowFormat();
+      }
+      if (row < 1 || row > market.rows || col < 1 || col > market.cols) {
+        ThrowFormat("Index out of range");
+      }
+      triplets.push_back({static_cast<int>(row - 1),
+                          static_cast<int>(col - 1), value});
+    }
+    p = NextLine(p, end);
+  }
+}
+
+// Заголовок и строка размеров читаются последовательно, данные делятся на
+// куски по границам строк и разбираются задачами пула; результаты кусков
+// склеиваются по порядку, так что порядок элементов array сохраняется
+Market Parse(const std::string &path) {
+  S21FileMapping mapping(path);
+  const char *p = mapping.Data(), *end = p + mapping.Size();
+  std::vector<std::string> banner = Words(p, end);
+  if (banner.size() != 5 || banner[0] != "%%matrixmarket" ||
+      banner[1] != "matrix") {
+    ThrowFormat();
+  }
+  Market market{};
+  if (banner[2] == "coordinate") {
+    market.format = Format::kCoordinate;
+  } else if (banner[2] == "array") {
+    market.format = Format::kArray;
+  } else {
+    ThrowFormat();
+  }
+  if (banner[3] == "real" || banner[3] == "double") {
+    market.field = Field::kReal;
+  } else if (banner[3] == "integer") {
+    market.field = Field::kInteger;
+  } else if (banner[3] == "pattern" && market.format == Format::kCoordinate) {
+    market.field = Field::kPattern;
+  } else {
+    ThrowFormat("Only real, integer and pattern fields are supported");
+  }
+  if (banner[4] == "general") {
+    market.symmetry = Symmetry::kGeneral;
+  } else if (banner[4] == "symmetric") {
+    market.symmetry = Symmetry::kSymmetric;
+  } else if (banner[4] == "skew-symmetric") {
+    market.symmetry = Symmetry::kSkew;
+  } else {
+    ThrowFormat("Only general, symmetric and skew-symmetric are supported");
+  }
+
+  p = NextLine(p, end);
+  for (const char *line = SkipBlanks(p, end);
+       line < end && (*line == '%' || *line == '\n');
+       line = SkipBlanks(p, end)) {
+    p = NextLine(line, end);
+  }
+  long long rows = 0, cols = 0, entries = 0;
+  if (!ParseNumber(p, end, rows) || !ParseNumber(p, end, cols) ||
+      (market.format == Format::kCoordinate &&
+       !ParseNumber(p, end, entries)) ||
+      rows < 1 || cols < 1 || rows > INT_MAX || cols > INT_MAX ||
+      (market.symmetry != Symmetry::kGeneral && rows != cols)) {
+    ThrowFormat();
+  }
+  market.rows = static_cast<int>(rows);
+  market.cols = static_cast<int>(cols);
+  if (market.format == Format::kArray) {
+    entries = market.symmetry == Symmetry::kGeneral ? rows * cols
+              : market.symmetry == Symmetry::kSymmetric
+                  ? rows * (rows + 1) / 2
+                  : rows * (rows - 1) / 2;
+  }
+  p = NextLine(p, end);
+
+  std::size_t bytes = end - p;
+  int chunks = static_cast<int>(std::min<std::size_t>(
+      bytes / kChunkBytes + 1, 4 * S21ThreadPool::Default().GetThreadCount()));
+  std::vector<const char *> bounds(chunks + 1, end);
+  bounds[0] = p;
+  for (int c = 1; c < chunks; ++c) {
+    const char *guess = p + bytes * c / chunks;
+    bounds[c] = std::max(bounds[c - 1], NextLine(guess - 1, end));
+  }
+  std::vector<std::vector<S21Triplet>> triplets(chunks);
+  std::vector<std::vector<double>> values(chunks);
+  S21ParallelFor(0, chunks, 1, [&](int lo, int hi) {
+    for (int c = lo; c < hi; ++c) {
+      ParseChunk(bounds[c], bounds[c + 1], market, triplets[c], values[c]);
+    }
+  });
+
+  long long found = 0;
+  for (int c = 0; c < chunks; ++c) {
+    found += triplets[c].size() + values[c].size();
+  }
+  if (found != entries) ThrowFormat("Wrong count of entries");
+  for (int c = 0; c < chunks; ++c) {
+    market.triplets.insert(market.triplets.end(), triplets[c].begin(),
+                           triplets[c].end());
+    market.values.insert(market.values.end(), values[c].begin(),
+                         values[c].end());
+  }
+  return market;
+}
+
+// Все элементы с учетом симметрии: f(строка, столбец, значение)
+template <typename F>
+void ForEachEntry(const Market &market, F f) {
+  auto emit = [&](int i, int j, double value) {
+    f(i, j, value);
+    if (i == j || market.symmetry == Symmetry::kGeneral) return;
+    f(j, i, market.symmetry == Symmetry::kSkew ? -value : value);
+  };
+  if (market.format == Format::kCoordinate) {
+    for (const S21Triplet &t : market.triplets) emit(t.row, t.col, t.value);
+    return;
+  }
+  // array перечисляет столбцы сверху вниз, для симметричных - только
+  // нижний треугольник (для кососимметричных - без диагонали)
+  std::size_t k = 0;
+  for (int j = 0; j < market.cols; ++j) {
+    int first = market.symmetry == Symmetry::kGeneral ? 0
+                : market.symmetry == Symmetry::kSymmetric ? j
+                                                          : j + 1;
+    for (int i = first; i < market.rows; ++i) emit(i, j, market.values[k++]);
+  }
+}
+
+S21Matrix ToDense(const Market &market) {
+  if (market.format == Format::kArray &&
+      market.symmetry == Symmetry::kGeneral) {
+    S21Matrix m = S21Matrix::FromBuffer(market.values.data(), market.rows,
+                                        market.cols, S21Layout::kColMajor);
+    m.ConvertTo(S21Layout::kRowMajor);
+    return m;
+  }
+  S21Matrix m(market.rows, market.cols);
+  double *data = m.Data();
+  int stride = m.Stride();
+  ForEachEntry(market, [data, stride](int i, int j, double value) {
+    data[static_cast<std::size_t>(i) * stride + j] += value;
+  });
+  return m;
+}
+
+S21SparseMatrix ToSparse(const Market &market) {
+  std::vector<S21Triplet> triplets;
+  triplets.reserve(market.triplets.size() + market.values.size());
+  ForEachEntry(market, [&triplets](int i, int j, double value) {
+    if (value != 0.0) triplets.push_back({i, j, value});
+  });
+  return S21SparseMatrix::FromTriplets(market.rows, market.cols,
+                                       std::move(triplets));
+}
+
+std::ofstream OpenOutput(const std::string &path) {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    throw std::system_error(errno, std::generic_category(),
+                            "\nCan't open " + path + "\n");
+  }
+  return out;
+}
+
+// кратчайшая запись, которая читается обратно в то же double
+void AppendNumber(std::string &line, double value) {
+  char buffer[32];
+  std::to_chars_result result = std::to_chars(buffer, buffer + 32, value);
+  line.append(buffer, result.ptr);
+}
+
+void Finish(std::ofstream &out, const std::string &path) {
+  if (!out.flush()) {
+    throw std::system_error(errno, std::generic_category(),
+                            "\nCan't write " + path + "\n");
+  }
+}
+
+}  // namespace
+
+S21Matrix S21ReadMarket(const std::string &path) {
+  return ToDense(Parse(path));
+}
+
+S21SparseMatrix S21ReadMarketSparse(const std::string &path) {
+  return ToSparse(Parse(path));
+}
+
+std::variant<S21Matrix, S21SparseMatrix> S21LoadMarket(
+    const std::string &path, double sparse_density) {
+  Market market = Parse(path);
+  double stored = static_cast<double>(market.triplets.size());
+  if (market.symmetry != Symmetry::kGeneral) stored *= 2;
+  if (market.format == Format::kCoordinate &&
+      stored < sparse_density * market.rows * market.cols) {
+    return ToSparse(market);
+  }
+  return ToDense(market);
+}
+
+// array перечисляет элементы по столбцам
+void S21WriteMarket(const std::string &path, const S21Matrix &m) {
+  std::ofstream out = OpenOutput(path);
+  out << "%%MatrixMarket matrix array real general\n"
+      << m.GetRows() << ' ' << m.GetCols() << '\n';
+  std::string line;
+  for (int j = 0; j < m.GetCols(); ++j) {
+    line.clear();
+    for (int i = 0; i < m.GetRows(); ++i) {
+      AppendNumber(line, m(i, j));
+      line += '\n';
+    }
+    out << line;
+  }
+  Finish(out, path);
+}
+
+void S21WriteMarket(const std::string &path, const S21SparseMatrix &m) {
+  std::ofstream out = OpenOutput(path);
+  out << "%%MatrixMarket matrix coordinate real general\n"
+      << m.GetRows() << ' ' << m.GetCols() << ' ' << m.GetNonZeros() << '\n';
+  std::string line;
+  for (int i = 0; i < m.GetRows(); ++i) {
+    line.clear();
+    for (int k = m.RowStarts()[i]; k < m.RowStarts()[i + 1]; ++k) {
+      line += std::to_string(i + 1) + ' ' +
+              std::to_string(m.Columns()[k] + 1) + ' ';
+      AppendNumber(line, m.Values()[k]);
+      line += '\n';
+    }
+    out << line;
+  }
+  Finish(out, path);
+}
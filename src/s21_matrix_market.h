@@ -0,0 +1,27 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_MARKET_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_MARKET_H
+
+#include <string>
+#include <variant>
+
+#include "s21_matrix_oop.h"
+#include "s21_sparse_matrix.h"
+
+#define S21_MARKET_SPARSE_DENSITY 0.1
+
+// Формат Matrix Market (.mtx): coordinate и array, поля real, integer и
+// pattern (значения 1), симметрии general, symmetric и skew-symmetric.
+// Файл отображается в память и разбирается кусками по строкам
+// параллельно в пуле. Ошибки формата - std::invalid_argument
+S21Matrix S21ReadMarket(const std::string &path);
+S21SparseMatrix S21ReadMarketSparse(const std::string &path);
+// coordinate с плотностью ниже sparse_density читается в разреженную
+// матрицу, остальное - в плотную
+std::variant<S21Matrix, S21SparseMatrix> S21LoadMarket(
+    const std::string &path, double sparse_density = S21_MARKET_SPARSE_DENSITY);
+
+// плотная пишется как array general, разреженная - как coordinate general
+void S21WriteMarket(const std::string &path, const S21Matrix &m);
+void S21WriteMarket(const std::string &path, const S21SparseMatrix &m);
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_MARKET_H
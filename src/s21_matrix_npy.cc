@@ -0,0 +1,463 @@
+#include "s21_matrix_npy.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include "s21_matrix_mapped.h"
+
+namespace {
+
+const char kNpyMagic[] = "\x93NUMPY";
+const std::size_t kNpyMagicBytes = 6;
+const std::size_t kZipLimit = 0xFFFFFFFFu;
+
+using Sink = std::function<void(const char *, std::size_t)>;
+
+struct NpyHeader {
+  char endian;
+  int item_bytes;
+  bool fortran;
+  int rows;
+  int cols;
+  std::size_t data_offset;  // от начала .npy
+};
+
+[[noreturn]] void ThrowFormat(const char *what) {
+  throw std::invalid_argument(std::string("\n") + what + "\n");
+}
+
+[[noreturn]] void ThrowSystemError(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), "\n" + what + "\n");
+}
+
+bool LittleEndianHost() {
+  const std::uint16_t probe = 1;
+  char first;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+bool NativeOrder(char endian) {
+  if (endian == '=' || endian == '|') return true;
+  return (endian == '<') == LittleEndianHost();
+}
+
+std::uint32_t Read32(const char *p) {
+  const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+  return u[0] | u[1] << 8 | u[2] << 16 | std::uint32_t(u[3]) << 24;
+}
+
+std::uint16_t Read16(const char *p) {
+  const unsigned char *u = reinterpret_cast<const unsigned char *>(p);
+  return static_cast<std::uint16_t>(u[0] | u[1] << 8);
+}
+
+std::uint64_t Read64(const char *p) {
+  return Read32(p) | std::uint64_t(Read32(p + 4)) << 32;
+}
+
+void Put16(std::string &out, std::uint32_t value) {
+  out += static_cast<char>(value & 0xFF);
+  out += static_cast<char>(value >> 8 & 0xFF);
+}
+
+void Put32(std::string &out, std::uint32_t value) {
+  Put16(out, value & 0xFFFF);
+  Put16(out, value >> 16);
+}
+
+// Значение ключа словаря заголовка: начало текста после "'key':"
+std::size_t FindKey(const std::string &dict, const char *key) {
+  std::size_t at = dict.find(std::string("'") + key + "'");
+  if (at == std::string::npos) ThrowFormat("Wrong .npy header");
+  at = dict.find(':', at);
+  if (at != std::string::npos) at = dict.find_first_not_of(" ", at + 1);
+  if (at == std::string::npos) ThrowFormat("Wrong .npy header");
+  return at;
+}
+
+// Заголовок - литерал словаря Python, например
+// {'descr': '<f8', 'fortran_order': False, 'shape': (3, 4), }
+NpyHeader ParseNpy(const char *data, std::size_t size) {
+  if (size < 10 || std::memcmp(data, kNpyMagic, kNpyMagicBytes) != 0) {
+    ThrowFormat("Wrong .npy file");
+  }
+  int major = static_cast<unsigned char>(data[6]);
+  std::size_t dict_offset = major == 1 ? 10 : 12;
+  if (major < 1 || major > 3 || size < dict_offset) {
+    ThrowFormat("Wrong .npy file");
+  }
+  std::size_t dict_bytes = major == 1 ? Read16(data + 8) : Read32(data + 8);
+  if (size < dict_offset + dict_bytes) ThrowFormat("Wrong .npy file");
+  std::string dict(data + dict_offset, dict_bytes);
+
+  NpyHeader header{};
+  header.data_offset = dict_offset + dict_bytes;
+  std::size_t at = FindKey(dict, "descr");
+  if (at + 4 > dict.size()) {
+    ThrowFormat("Wrong .npy header");
+  }
+  std::string descr = dict.substr(at + 1, 3);
+  header.endian = descr[0];
+  if (std::string("<>=|").find(header.endian) == std::string::npos ||
+      (descr.substr(1) != "f8" && descr.substr(1) != "f4")) {
+    ThrowFormat("Only float32 and float64 arrays are supported");
+  }
+  header.item_bytes = descr[2] - '0';
+  header.fortran = dict.compare(FindKey(dict, "fortran_order"), 4, "True") == 0;
+
+  at = FindKey(dict, "shape");
+  std::size_t end = dict.find(')', at);
+  if (dict[at] != '(' || end == std::string::npos) {
+    ThrowFormat("Wrong .npy header");
+  }
+  std::vector<long long> shape;
+  for (std::size_t i = at + 1; i < end;) {
+    if (dict[i] < '0' || dict[i] > '9') {
+      ++i;
+      continue;
+    }
+    long long extent = 0;
+    for (; dict[i] >= '0' && dict[i] <= '9'; ++i) {
+      extent = extent * 10 + (dict[i] - '0');
+      extent = std::min<long long>(extent, INT_MAX + 1LL);
+    }
+    shape.push_back(extent);
+  }
+  if (shape.size() > 2) ThrowFormat("Only 1-D and 2-D arrays are supported");
+  shape.resize(2, 1);
+  if (shape[0] < 1 || shape[1] < 1 || shape[0] > INT_MAX ||
+      shape[1] > INT_MAX) {
+    ThrowFormat("Wrong count of rows or columns");
+  }
+  header.rows = static_cast<int>(shape[0]);
+  header.cols = static_cast<int>(shape[1]);
+  // произведение из заголовка может переполнить size_t и пройти проверку
+  if (static_cast<std::size_t>(header.rows) >
+      SIZE_MAX / header.cols / header.item_bytes) {
+    ThrowFormat("Wrong .npy file");
+  }
+  std::size_t data_bytes = static_cast<std::size_t>(header.rows) *
+                           header.cols * header.item_bytes;
+  if (size - header.data_offset < data_bytes) ThrowFormat("Wrong .npy file");
+  return header;
+}
+
+// Копия данных .npy; выравнивание не требуется
+S21Matrix Decode(const char *npy, const NpyHeader &header) {
+  const char *bytes = npy + header.data_offset;
+  S21Layout layout = header.fortran ? S21Layout::kColMajor
+                                    : S21Layout::kRowMajor;
+  std::size_t count = static_cast<std::size_t>(header.rows) * header.cols;
+  bool swap = !NativeOrder(header.endian);
+  if (header.item_bytes == 8 && !swap &&
+      reinterpret_cast<std::uintptr_t>(bytes) % alignof(double) == 0) {
+    return S21Matrix::FromBuffer(reinterpret_cast<const double *>(bytes),
+                                 header.rows, header.cols, layout);
+  }
+  std::vector<double> values(count);
+  if (header.item_bytes == 8 && !swap) {
+    std::memcpy(values.data(), bytes, count * sizeof(double));
+  } else {
+    char item[8];
+    for (std::size_t i = 0; i < count; ++i) {
+      std::memcpy(item, bytes + i * header.item_bytes, header.item_bytes);
+      if (swap) std::reverse(item, item + header.item_bytes);
+      if (header.item_bytes == 8) {
+        std::memcpy(&values[i], item, sizeof(double));
+      } else {
+        float value;
+        std::memcpy(&value, item, sizeof(float));
+        values[i] = value;
+      }
+    }
+  }
+  return S21Matrix::FromBuffer(values.data(), header.rows, header.cols,
+                               layout);
+}
+
+// Магия, версия 1.0, словарь и пробелы до границы 64 байт, чтобы данные
+// были выровнены для отображения в память
+std::string NpyHeaderBytes(const S21Matrix &m, S21NpyType type) {
+  std::string dict = std::string("{'descr': '") +
+                     (LittleEndianHost() ? '<' : '>') +
+                     (type == S21NpyType::kFloat64 ? "f8" : "f4") +
+                     "', 'fortran_order': " +
+                     (m.GetLayout() == S21Layout::kColMajor ? "True"
+                                                            : "False") +
+                     ", 'shape': (" + std::to_string(m.GetRows()) + ", " +
+                     std::to_string(m.GetCols()) + "), }";
+  std::size_t padded = (10 + dict.size() + 1 + 63) / 64 * 64;
+  dict.append(padded - 10 - dict.size() - 1, ' ');
+  dict += '\n';
+  std::string header(kNpyMagic, kNpyMagicBytes);
+  header += '\x01';
+  header += '\x00';
+  Put16(header, static_cast<std::uint32_t>(dict.size()));
+  return header + dict;
+}
+
+std::size_t NpyBytes(const S21Matrix &m, S21NpyType type) {
+  std::size_t item = type == S21NpyType::kFloat64 ? 8 : 4;
+  return NpyHeaderBytes(m, type).size() +
+         static_cast<std::size_t>(m.GetRows()) * m.GetCols() * item;
+}
+
+// Строки буфера пишутся как есть, поэтому раскладка сохраняется
+void WriteNpy(const S21Matrix &m, S21NpyType type, const Sink &sink) {
+  std::string header = NpyHeaderBytes(m, type);
+  sink(header.data(), header.size());
+  bool row_major = m.GetLayout() == S21Layout::kRowMajor;
+  int lines = row_major ? m.GetRows() : m.GetCols();
+  int length = row_major ? m.GetCols() : m.GetRows();
+  std::vector<float> narrow(type == S21NpyType::kFloat32 ? length : 0);
+  for (int i = 0; i < lines; ++i) {
+    const double *line = m.Data() + static_cast<std::size_t>(i) * m.Stride();
+    if (type == S21NpyType::kFloat64) {
+      sink(reinterpret_cast<const char *>(line), length * sizeof(double));
+    } else {
+      std::copy(line, line + length, narrow.begin());
+      sink(reinterpret_cast<const char *>(narrow.data()),
+           length * sizeof(float));
+    }
+  }
+}
+
+std::ofstream OpenOutput(const std::string &path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) ThrowSystemError("Can't open " + path);
+  return out;
+}
+
+std::uint32_t Crc32(std::uint32_t crc, const char *data, std::size_t size) {
+  static const std::vector<std::uint32_t> table = [] {
+    std::vector<std::uint32_t> result(256);
+    for (std::uint32_t i = 0; i < 256; ++i) {
+      std::uint32_t value = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        value = value & 1 ? 0xEDB88320u ^ value >> 1 : value >> 1;
+      }
+      result[i] = value;
+    }
+    return result;
+  }();
+  crc = ~crc;
+  for (std::size_t i = 0; i < size; ++i) {
+    crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ crc >> 8;
+  }
+  return ~crc;
+}
+
+// Общая часть локального и центрального заголовков ZIP начиная с поля
+// "версия для распаковки": метод 0 (без сжатия), дата 1980-01-01
+std::string ZipEntryFields(std::uint32_t crc, std::uint32_t bytes,
+                           const std::string &name) {
+  std::string fields;
+  Put16(fields, 20);
+  Put16(fields, 0);
+  Put16(fields, 0);
+  Put16(fields, 0);
+  Put16(fields, 0x21);
+  Put32(fields, crc);
+  Put32(fields, bytes);
+  Put32(fields, bytes);
+  Put16(fields, static_cast<std::uint32_t>(name.size()));
+  Put16(fields, 0);
+  return fields;
+}
+
+// Поля записи центрального каталога; в ZIP64 размеры и смещение, равные
+// 0xFFFFFFFF, лежат в дополнительном поле 0x0001
+struct ZipEntry {
+  std::string name;
+  std::uint64_t bytes;
+  std::uint64_t offset;
+  int method;
+};
+
+// Поле ZIP64 содержит только те значения, которые не уместились в 32 бита,
+// по порядку; каждое читается с проверкой длины поля
+std::uint64_t NextZip64(const char *&field, const char *field_end) {
+  if (field_end - field < 8) ThrowFormat("Wrong .npz file");
+  std::uint64_t value = Read64(field);
+  field += 8;
+  return value;
+}
+
+ZipEntry ReadCentralEntry(const char *p, const char *end) {
+  ZipEntry entry;
+  entry.method = Read16(p + 10);
+  entry.bytes = Read32(p + 24);
+  std::uint64_t packed = Read32(p + 20);
+  entry.offset = Read32(p + 42);
+  std::size_t name_bytes = Read16(p + 28), extra_bytes = Read16(p + 30);
+  if (p + 46 + name_bytes + extra_bytes > end) ThrowFormat("Wrong .npz file");
+  entry.name.assign(p + 46, name_bytes);
+  const char *extra = p + 46 + name_bytes, *extra_end = extra + extra_bytes;
+  while (extra + 4 <= extra_end) {
+    const char *field = extra + 4, *field_end = field + Read16(extra + 2);
+    if (field_end > extra_end) ThrowFormat("Wrong .npz file");
+    if (Read16(extra) == 1) {
+      if (entry.bytes == kZipLimit) entry.bytes = NextZip64(field, field_end);
+      if (packed == kZipLimit) NextZip64(field, field_end);
+      if (entry.offset == kZipLimit) {
+        entry.offset = NextZip64(field, field_end);
+      }
+    }
+    extra = field_end;
+  }
+  return entry;
+}
+
+}  // namespace
+
+void S21SaveNpy(const std::string &path, const S21Matrix &m,
+                S21NpyType type) {
+  std::ofstream out = OpenOutput(path);
+  WriteNpy(m, type, [&out](const char *data, std::size_t size) {
+    out.write(data, size);
+  });
+  if (!out.flush()) ThrowSystemError("Can't write " + path);
+}
+
+S21Matrix S21LoadNpy(const std::string &path) {
+  S21FileMapping mapping(path);
+  return Decode(mapping.Data(),
+                ParseNpy(mapping.Data(), mapping.Size()));
+}
+
+// Отображение принадлежит удалителю представления и закрывается вместе
+// с матрицей
+S21Matrix S21MapNpy(const std::string &path, bool writable) {
+  auto mapping = std::make_shared<S21FileMapping>(path, writable);
+  NpyHeader header = ParseNpy(mapping->Data(), mapping->Size());
+  if (header.item_bytes != 8 || !NativeOrder(header.endian) ||
+      header.data_offset % alignof(double) != 0) {
+    return Decode(mapping->Data(), header);
+  }
+  double *data =
+      reinterpret_cast<double *>(mapping->Data() + header.data_offset);
+  int stride = header.fortran ? header.rows : header.cols;
+  return S21Matrix(
+      data, header.rows, header.cols, stride,
+      header.fortran ? S21Layout::kColMajor : S21Layout::kRowMajor,
+      [mapping](double *) mutable { mapping.reset(); });
+}
+
+// Локальный заголовок пишется после данных, когда известна CRC, поэтому
+// массив не копируется в память целиком
+void S21SaveNpz(const std::string &path,
+                const std::map<std::string, S21Matrix> &arrays,
+                S21NpyType type) {
+  std::ofstream out = OpenOutput(path);
+  std::string directory;
+  for (const auto &[key, m] : arrays) {
+    std::string name = key + ".npy";
+    std::uint64_t offset = out.tellp(), bytes = NpyBytes(m, type);
+    if (offset >= kZipLimit || bytes >= kZipLimit) {
+      throw std::length_error("\nThe archive is too large for .npz\n");
+    }
+    std::string local;
+    Put32(local, 0x04034b50);
+    local += ZipEntryFields(0, 0, name) + name;
+    out.write(local.data(), local.size());
+    std::uint32_t crc = 0;
+    WriteNpy(m, type, [&out, &crc](const char *data, std::size_t size) {
+      crc = Crc32(crc, data, size);
+      out.write(data, size);
+    });
+    std::uint64_t next = out.tellp();
+    std::string fields = ZipEntryFields(crc, bytes, name);
+    out.seekp(offset + 4);
+    out.write(fields.data(), fields.size());
+    out.seekp(next);
+
+    Put32(directory, 0x02014b50);
+    Put16(directory, 20);
+    directory += fields;
+    Put16(directory, 0);  // комментарий
+    Put16(directory, 0);  // номер диска
+    Put16(directory, 0);  // внутренние атрибуты
+    Put32(directory, 0);  // внешние атрибуты
+    Put32(directory, static_cast<std::uint32_t>(offset));
+    directory += name;
+  }
+  std::uint64_t directory_offset = out.tellp();
+  if (directory_offset >= kZipLimit) {
+    throw std::length_error("\nThe archive is too large for .npz\n");
+  }
+  std::string end;
+  Put32(end, 0x06054b50);
+  Put16(end, 0);
+  Put16(end, 0);
+  Put16(end, static_cast<std::uint32_t>(arrays.size()));
+  Put16(end, static_cast<std::uint32_t>(arrays.size()));
+  Put32(end, static_cast<std::uint32_t>(directory.size()));
+  Put32(end, static_cast<std::uint32_t>(directory_offset));
+  Put16(end, 0);
+  out.write(directory.data(), directory.size());
+  out.write(end.data(), end.size());
+  if (!out.flush()) ThrowSystemError("Can't write " + path);
+}
+
+// Конец центрального каталога ищется с конца файла (после него может
+// идти комментарий до 64 КБ). numpy пишет записи с полями ZIP64, поэтому
+// они читаются и в обычных архивах
+std::map<std::string, S21Matrix> S21LoadNpz(const std::string &path) {
+  S21FileMapping mapping(path);
+  const char *data = mapping.Data(), *file_end = data + mapping.Size();
+  std::size_t size = mapping.Size();
+  if (size < 22) ThrowFormat("Wrong .npz file");
+  std::size_t eocd = size - 22;
+  while (Read32(data + eocd) != 0x06054b50) {
+    if (eocd == 0 || size - eocd > 22 + 0xFFFF) {
+      ThrowFormat("Wrong .npz file");
+    }
+    --eocd;
+  }
+  std::uint64_t entries = Read16(data + eocd + 10);
+  std::uint64_t directory = Read32(data + eocd + 16);
+  if (directory == kZipLimit && eocd >= 20 &&
+      Read32(data + eocd - 20) == 0x07064b50) {
+    std::uint64_t record = Read64(data + eocd - 20 + 8);
+    if (record + 56 > size || Read32(data + record) != 0x06064b50) {
+      ThrowFormat("Wrong .npz file");
+    }
+    entries = Read64(data + record + 32);
+    directory = Read64(data + record + 48);
+  }
+
+  std::map<std::string, S21Matrix> arrays;
+  const char *p = data + std::min<std::uint64_t>(directory, size);
+  for (std::uint64_t i = 0; i < entries; ++i) {
+    if (p + 46 > file_end || Read32(p) != 0x02014b50) {
+      ThrowFormat("Wrong .npz file");
+    }
+    ZipEntry entry = ReadCentralEntry(p, file_end);
+    p += 46 + Read16(p + 28) + Read16(p + 30) + Read16(p + 32);
+    if (entry.method != 0) ThrowFormat("Compressed .npz is not supported");
+    if (entry.offset + 30 > size) ThrowFormat("Wrong .npz file");
+    const char *local = data + entry.offset;
+    std::uint64_t begin =
+        entry.offset + 30 + Read16(local + 26) + Read16(local + 28);
+    if (begin > size || size - begin < entry.bytes) {
+      ThrowFormat("Wrong .npz file");
+    }
+    std::string name = entry.name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0) {
+      name.resize(name.size() - 4);
+    }
+    const char *npy = data + begin;
+    arrays.emplace(name, Decode(npy, ParseNpy(npy, entry.bytes)));
+  }
+  return arrays;
+}
@@ -0,0 +1,34 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_NPY_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_NPY_H
+
+#include <map>
+#include <string>
+
+#include "s21_matrix_oop.h"
+
+// Формат NumPy .npy (версии 1-3) и несжатые архивы .npz. Читаются
+// массивы float64 и float32 с любым порядком байт, в порядке C и Fortran.
+// Одномерный массив длины n становится столбцом n x 1, скаляр - 1 x 1.
+// Запись идет в раскладке матрицы: kColMajor сохраняется как
+// fortran_order, поэтому буфер пишется без перестановки. Ошибки формата -
+// std::invalid_argument, ошибки ОС - std::system_error
+enum class S21NpyType { kFloat64, kFloat32 };
+
+void S21SaveNpy(const std::string &path, const S21Matrix &m,
+                S21NpyType type = S21NpyType::kFloat64);
+S21Matrix S21LoadNpy(const std::string &path);  // копия в памяти
+// Без копирования: если файл хранит float64 в порядке байт машины,
+// результат - представление над отображенным в память файлом, и загрузка
+// стоит столько же, сколько mmap. Отображение живет, пока жива матрица;
+// writable - запись в матрицу меняет файл, иначе запись допустима, но
+// остается в памяти процесса. Для других типов читается копия
+S21Matrix S21MapNpy(const std::string &path, bool writable = false);
+
+// Ключи - имена массивов без ".npy", как в numpy.savez. Записи архива
+// больше 4 ГБ (ZIP64) поддерживаются только при чтении
+void S21SaveNpz(const std::string &path,
+                const std::map<std::string, S21Matrix> &arrays,
+                S21NpyType type = S21NpyType::kFloat64);
+std::map<std::string, S21Matrix> S21LoadNpz(const std::string &path);
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_NPY_H
@@ -1,5 +1,106 @@
 #include "s21_matrix_oop.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+
+#include "s21_matrix_alloc.h"
+#include "s21_matrix_stats.h"
+
+namespace {
+
+const int kRefineMaxIterations = 30;
+
+#ifdef S21_MATRIX_STATS
+// оценки числа операций для счетчиков S21_STATS_SCOPE
+double CofactorFlops(int n) { return n > 1 ? 2.0 * std::tgamma(n + 1.0) : 1; }
+
+double LUFlops(int n, int rhs) {
+  return 2.0 * n * n * n / 3 + 2.0 * n * n * rhs;
+}
+#endif
+
+// LU-разложение во float для SolveRefined, хранится одним блоком n * n
+class FloatLU {
+ public:
+  explicit FloatLU(int n) : n_(n), lu_(n * n), perm_(n) {}
+
+  float *Row(int i) { return &lu_[static_cast<size_t>(i) * n_]; }
+
+  // false, если матрица вырождена или не помещается во float
+  bool Factorize(double **matrix) {
+    for (int i = 0; i < n_; ++i) {
+      perm_[i] = i;
+      for (int j = 0; j < n_; ++j) {
+        Row(i)[j] = static_cast<float>(matrix[i][j]);
+        if (!std::isfinite(Row(i)[j])) return false;
+      }
+    }
+    for (int k = 0; k < n_; ++k) {
+      int pivot = k;
+      for (int i = k + 1; i < n_; ++i) {
+        if (std::fabs(Row(i)[k]) > std::fabs(Row(pivot)[k])) pivot = i;
+      }
+      if (Row(pivot)[k] == 0.0f) return false;
+      if (pivot != k) {
+        std::swap_ranges(Row(k), Row(k) + n_, Row(pivot));
+        std::swap(perm_[k], perm_[pivot]);
+      }
+      float *row_k = Row(k);
+      for (int i = k + 1; i < n_; ++i) {
+        float *row_i = Row(i);
+        float factor = row_i[k] / row_k[k];
+        row_i[k] = factor;
+        if (factor == 0.0f) continue;
+        for (int j = k + 1; j < n_; ++j) row_i[j] -= factor * row_k[j];
+      }
+    }
+    return true;
+  }
+
+  // решает A * x = b для одного столбца на месте, b уже в double
+  void Solve(std::vector<float> &x, const std::vector<double> &b) {
+    for (int i = 0; i < n_; ++i) {
+      float sum = static_cast<float>(b[perm_[i]]);
+      const float *row = Row(i);
+      for (int k = 0; k < i; ++k) sum -= row[k] * x[k];
+      x[i] = sum;
+    }
+    for (int i = n_ - 1; i >= 0; --i) {
+      float sum = x[i];
+      const float *row = Row(i);
+      for (int k = i + 1; k < n_; ++k) sum -= row[k] * x[k];
+      x[i] = sum / row[i];
+    }
+  }
+
+ private:
+  int n_;
+  std::vector<float> lu_;
+  std::vector<int> perm_;
+};
+
+}  // namespace
+
+struct S21Matrix::Cache {
+  bool has_det = false;
+  double det = 0.0;
+  std::unique_ptr<S21Matrix> lu;
+  std::vector<int> perm;
+  std::unique_ptr<S21Matrix> inverse;
+};
+
+struct S21Matrix::Shared {
+  std::atomic<int> refs{1};
+};
+
+struct S21Matrix::External {
+  double *data;
+  int stride;
+  S21BufferDeleter deleter;
+};
+
 // ------------------------------ constructor destructor
 // ---------------------------------
 
@@ -9,44 +110,105 @@ S21Matrix::S21Matrix(int rows, int cols) : rows_(rows), cols_(cols) {
   CreateMatrix();
 }
 
-S21Matrix::S21Matrix(const S21Matrix &other)
-    : rows_(other.rows_), cols_(other.cols_) {
+S21Matrix::S21Matrix(int rows, int cols, S21ExecutionPolicy policy)
+    : rows_(rows), cols_(cols) {
+  CreateMatrix(policy);
+}
+
+S21Matrix::S21Matrix(int rows, int cols, S21Layout layout)
+    : rows_(layout == S21Layout::kColMajor ? cols : rows),
+      cols_(layout == S21Layout::kColMajor ? rows : cols),
+      transposed_(layout == S21Layout::kColMajor) {
   CreateMatrix();
-  CopyMatrix(other);
+}
+
+S21Matrix::S21Matrix(double *data, int rows, int cols, int stride,
+                     S21BufferDeleter deleter)
+    : S21Matrix(data, rows, cols, stride, S21Layout::kRowMajor,
+                std::move(deleter)) {}
+
+S21Matrix::S21Matrix(double *data, int rows, int cols, int stride,
+                     S21Layout layout, S21BufferDeleter deleter)
+    : rows_(layout == S21Layout::kColMajor ? cols : rows),
+      cols_(layout == S21Layout::kColMajor ? rows : cols),
+      matrix_(nullptr),
+      transposed_(layout == S21Layout::kColMajor) {
+  if (!data || rows_ <= 0 || cols_ <= 0 || stride < cols_) {
+    throw std::invalid_argument("\nWrong external buffer\n");
+  }
+  std::unique_ptr<External> external(
+      new External{data, stride, std::move(deleter)});
+  // external_ выставляется до BlockBytes(): в блоке только таблица строк
+  external_ = external.get();
+  matrix_ = static_cast<double **>(S21MatrixAllocate(BlockBytes()));
+  for (int i = 0; i < rows_; ++i) {
+    matrix_[i] = data + static_cast<std::size_t>(i) * stride;
+  }
+  external.release();
+}
+
+S21Matrix::S21Matrix(const S21Matrix &other)
+    : S21Matrix(other, S21ExecutionPolicy::kSeq) {}
+
+// без предварительного зануления: первой страницы касается поток, который
+// копирует в нее свой блок строк
+S21Matrix::S21Matrix(const S21Matrix &other, S21ExecutionPolicy policy)
+    : rows_(other.rows_),
+      cols_(other.cols_),
+      cow_(other.cow_),
+      transposed_(other.transposed_) {
+  if (!ShareFrom(other)) {
+    AllocateMatrix();
+    CopyMatrix(other, policy);
+    AdoptShared();
+  }
 }
 
 S21Matrix::S21Matrix(S21Matrix &&other)
-    : rows_(other.rows_), cols_(other.cols_), matrix_(other.matrix_) {
-  other.SetNull();
+    : rows_(0),
+      cols_(0),
+      matrix_(nullptr),
+      cache_(other.cache_),
+      cow_(other.cow_) {
+  MoveMatrix(other);
+  other.cache_ = nullptr;
 }
 
 void S21Matrix::SetNull() {
   matrix_ = nullptr;
+  shared_ = nullptr;
+  external_ = nullptr;
   rows_ = 0;
   cols_ = 0;
+  transposed_ = false;
 }
 
-S21Matrix::~S21Matrix() { DestroyMatrix(); }
+S21Matrix::~S21Matrix() {
+  DestroyMatrix();
+  delete cache_;
+  cache_ = nullptr;
+}
 
 //------------------------------ operators ---------------------------------
 
 S21Matrix S21Matrix::operator=(const S21Matrix &other) {
-  this->~S21Matrix();
+  DestroyMatrix();
+  Touch();
   rows_ = other.rows_;
   cols_ = other.cols_;
-  CreateMatrix();
-  CopyMatrix(other);
+  transposed_ = other.transposed_;
+  if (!ShareFrom(other)) {
+    CreateMatrix();
+    CopyMatrix(other);
+  }
   return *this;
 }
 
 S21Matrix S21Matrix::operator=(S21Matrix &&other) {
   if (this != &other) {
-    this->~S21Matrix();
-    rows_ = other.rows_;
-    cols_ = other.cols_;
-    CreateMatrix();
-    matrix_ = other.matrix_;
-    other.SetNull();
+    // буфер заменяется целиком: общий отпустит MoveMatrix без копии
+    if (cache_) InvalidateCache();
+    MoveMatrix(other);
   }
   return *this;
 }
@@ -104,33 +266,98 @@ S21Matrix operator*(double num, S21Matrix &other) {
 }
 
 double &S21Matrix::operator()(int rows, int columns) {
-  if (rows >= rows_ || columns >= cols_) {
+  if (rows >= GetRows() || columns >= GetCols()) {
     throw std::invalid_argument("\nIndex out of range\n");
   }
-  return matrix_[rows][columns];
+  Touch();
+  return transposed_ ? matrix_[columns][rows] : matrix_[rows][columns];
+}
+
+double S21Matrix::operator()(int rows, int columns) const {
+  if (rows >= GetRows() || columns >= GetCols()) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  return transposed_ ? matrix_[columns][rows] : matrix_[rows][columns];
 }
 
 //------------------------------ methods ---------------------------------
 
+// Миноры первой строки независимы: для больших порядков они считаются
+// группой задач, вложенные уровни рекурсии порождают свои группы, а
+// ожидающие потоки выполняют задачи своих групп. Сумма собирается в
+// исходном порядке, поэтому результат не зависит от числа потоков
+double S21Matrix::CofactorDeterminant() {
+  S21CheckCancelled();
+  if (rows_ == 1) {
+    return matrix_[0][0];
+  } else if (rows_ == 2) {
+    return matrix_[0][0] * matrix_[1][1] - matrix_[0][1] * matrix_[1][0];
+  }
+
+  std::vector<double> minors(cols_);
+  if (rows_ >= S21_PARALLEL_DET_MIN) {
+    S21TaskGroup group;
+    for (int j = 0; j < cols_; ++j) {
+      group.Run([this, &minors, j] {
+        minors[j] = Submatrix(0, j).CofactorDeterminant();
+      });
+    }
+    group.Wait();
+  } else {
+    for (int j = 0; j < cols_; ++j) {
+      minors[j] = Submatrix(0, j).CofactorDeterminant();
+    }
+  }
+
+  double det = 0.0;
+  for (int j = 0; j < cols_; ++j) {
+    double a_0j = transposed_ ? matrix_[j][0] : matrix_[0][j];
+    det += (j % 2 == 0 ? 1 : -1) * a_0j * minors[j];
+  }
+  return det;
+}
+
 // Вычисляет матрицу алгебраических дополнений текущей матрицы и возвращает ее
 S21Matrix S21Matrix::CalcComplements() {
+  S21_STATS_SCOPE(S21Op::kCalcComplements, Elements(),
+                  Elements() * CofactorFlops(rows_ - 1),
+                  8.0 * Elements() * CofactorFlops(rows_ - 1));
   if (rows_ != cols_) {
     throw std::invalid_argument("\nThe matrix must be square\n");
   }
+  // дополнения A^T - это транспонированные дополнения A
+  if (transposed_) {
+    S21Matrix complements = StorageView().CalcComplements();
+    complements.transposed_ = true;
+    return complements;
+  }
+
+  if (rows_ == 1) {
+    throw std::invalid_argument("The matrix is not correct");
+  }
 
   S21Matrix complements(rows_, cols_);
 
-  for (int i = 0; i < rows_; ++i) {
+  auto fill_row = [this, &complements](int i) {
+    S21CheckCancelled();
     for (int j = 0; j < cols_; ++j) {
       S21Matrix submatrix = Submatrix(i, j);
-      double det = submatrix.Determinant();
+      double det = submatrix.CofactorDeterminant();
       complements.matrix_[i][j] = ((i + j) % 2 == 0 ? 1 : -1) * det;
     }
+  };
+  if (rows_ >= S21_PARALLEL_DET_MIN) {
+    S21TaskGroup group;
+    for (int i = 0; i < rows_; ++i) group.Run([&fill_row, i] { fill_row(i); });
+    group.Wait();
+  } else {
+    for (int i = 0; i < rows_; ++i) fill_row(i);
   }
   return complements;
 }
 
 S21Matrix S21Matrix::Submatrix(int row, int col) {
+  if (transposed_) std::swap(row, col);  // в буфере они меняются местами
   if (row >= rows_ || col >= cols_ || row < 0 || col < 0) {
     throw std::out_of_range("Index outside the matrix");
   }
@@ -145,37 +372,82 @@ S21Matrix S21Matrix::Submatrix(int row, int col) {
     }
     sub_i++;
   }
+  sub.transposed_ = transposed_;
   return sub;
 }
 
 // Вычисляет и возвращает определитель текущей матрицы
 double S21Matrix::Determinant() {
+  S21_STATS_SCOPE(S21Op::kDeterminant, Elements(), CofactorFlops(rows_),
+                  8.0 * CofactorFlops(rows_));
   if (rows_ != cols_) {
     throw std::invalid_argument("nThe matrix must be square");
   } else if (rows_ <= 0 || cols_ <= 0) {
     throw std::invalid_argument("The matrix is not correct");
   }
+  if (cache_ && cache_->has_det) return cache_->det;
 
-  if (rows_ == 1) {
-    return matrix_[0][0];
-  } else if (rows_ == 2) {
-    return matrix_[0][0] * matrix_[1][1] - matrix_[0][1] * matrix_[1][0];
-  }
+  double det = CofactorDeterminant();
 
-  double det = 0.0;
+  if (cache_) {
+    cache_->det = det;
+    cache_->has_det = true;
+  }
+  return det;
+}
 
-  // Рекурсивное разложение на миноры
-  for (int j = 0; j < cols_; ++j) {
-    S21Matrix submatrix = Submatrix(0, j);  // Получаем подматрицу
-    det += (j % 2 == 0 ? 1 : -1) * matrix_[0][j] * submatrix.Determinant();
+// Метод Барейса: после шага k все элементы - миноры исходной матрицы,
+// поэтому деление на предыдущий ведущий элемент всегда нацело
+S21BigInt S21Matrix::DeterminantExact() const {
+  S21_STATS_SCOPE(S21Op::kDeterminantExact, Elements(),
+                  2.0 * rows_ * rows_ * rows_ / 3, 8.0 * Elements());
+  if (rows_ != cols_) {
+    throw std::invalid_argument("nThe matrix must be square");
+  } else if (rows_ <= 0 || cols_ <= 0) {
+    throw std::invalid_argument("The matrix is not correct");
+  }
+  int n = rows_;
+  std::vector<std::vector<S21BigInt>> m(n, std::vector<S21BigInt>(n));
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      if (std::trunc(matrix_[i][j]) != matrix_[i][j]) {
+        throw std::invalid_argument("\nThe matrix must be integer-valued\n");
+      }
+      m[i][j] = S21BigInt::FromDouble(matrix_[i][j]);
+    }
   }
 
-  return det;
+  S21BigInt previous(1);
+  bool negative = false;
+  for (int k = 0; k < n - 1; ++k) {
+    S21CheckCancelled();
+    if (m[k][k].IsZero()) {
+      int pivot = k + 1;
+      while (pivot < n && m[pivot][k].IsZero()) ++pivot;
+      if (pivot == n) return S21BigInt(0);
+      std::swap(m[k], m[pivot]);
+      negative = !negative;
+    }
+    bool divide = previous != S21BigInt(1);
+    for (int i = k + 1; i < n; ++i) {
+      for (int j = k + 1; j < n; ++j) {
+        S21BigInt value = m[i][j] * m[k][k];
+        if (!m[i][k].IsZero()) value = value - m[i][k] * m[k][j];
+        m[i][j] = divide ? value / previous : value;
+      }
+    }
+    previous = m[k][k];
+  }
+  return negative ? -m[n - 1][n - 1] : m[n - 1][n - 1];
 }
 
 S21Matrix S21Matrix::InverseMatrix() {
+  S21_STATS_SCOPE(S21Op::kInverseMatrix, Elements(),
+                  (Elements() + rows_) * CofactorFlops(rows_ - 1),
+                  8.0 * (Elements() + rows_) * CofactorFlops(rows_ - 1));
+  if (cache_ && cache_->inverse) return *cache_->inverse;
   S21Matrix temp(*this);
-  double det = temp.Determinant();
+  double det = Determinant();
   if (temp.rows_ != temp.cols_) {
     throw std::invalid_argument("\nRows and columns must match\n");
   } else if (std::fabs(det) < EPS) {
@@ -186,114 +458,919 @@ S21Matrix S21Matrix::InverseMatrix() {
   temp = temp.Transpose();
   temp.MulNumber(1 / det);
 
+  if (cache_) cache_->inverse.reset(new S21Matrix(temp));
   return temp;
 }
 
-int S21Matrix::EqualMatrix(const S21Matrix &other) {
-  return (other.cols_ == this->cols_) && (other.rows_ == this->rows_);
+// Решает систему A * X = B через LU-разложение с выбором главного элемента
+S21Matrix S21Matrix::Solve(const S21Matrix &b) const {
+  S21_STATS_SCOPE(S21Op::kSolve, Elements(), LUFlops(rows_, b.cols_),
+                  16.0 * (Elements() + rows_ * b.cols_));
+  if (rows_ != cols_) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  } else if (b.GetRows() != rows_) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  S21Matrix b_storage;
+  const S21Matrix &rhs = RowMajor(b, b_storage);
+  // разложение всегда строится по буферу, для A^T решается U^T L^T P X = B
+  auto solve = transposed_ ? SolveLUTransposed : SolveLU;
+  if (!cache_) {
+    S21Matrix lu(rows_, cols_);
+    std::vector<int> perm;
+    FactorizeLU(lu, perm);
+    return solve(lu, perm, rhs);
+  }
+  if (!cache_->lu) {
+    std::unique_ptr<S21Matrix> lu(new S21Matrix(rows_, cols_));
+    FactorizeLU(*lu, cache_->perm);
+    cache_->lu = std::move(lu);
+  }
+  return solve(*cache_->lu, cache_->perm, rhs);
 }
 
-S21Matrix S21Matrix::Transpose() {
-  S21Matrix Temp(cols_, rows_);
-  for (int i = 0; i < rows_; i++) {
-    for (int j = 0; j < cols_; j++) {
-      Temp.matrix_[j][i] = matrix_[i][j];
+// Смешанная точность: O(n^3) работы идет во float, а каждое уточнение
+// x += A^-1 (b - A x) стоит O(n^2) с невязкой в double. Если уточнение
+// перестает сходиться, задача решается заново обычным Solve.
+S21Matrix S21Matrix::SolveRefined(const S21Matrix &b,
+                                  S21RefineStats *stats) const {
+  S21_STATS_SCOPE(S21Op::kSolveRefined, Elements(),
+                  LUFlops(rows_, b.cols_),
+                  20.0 * Elements() + 16.0 * rows_ * b.cols_);
+  if (rows_ != cols_) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  } else if (b.GetRows() != rows_) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  if (transposed_ || b.transposed_) {
+    return Materialized().SolveRefined(b.Materialized(), stats);
+  }
+  int n = rows_, m = b.cols_;
+  S21RefineStats local;
+  if (!stats) stats = &local;
+  *stats = S21RefineStats();
+
+  FloatLU lu(n);
+  S21Matrix x(n, m), r(n, m);
+  bool ok = lu.Factorize(matrix_);
+  std::vector<double> column(n);
+  std::vector<float> correction(n);
+  double norm_a = NormInf();
+  double tolerance = std::numeric_limits<double>::epsilon() *
+                     std::sqrt(static_cast<double>(n)) * norm_a;
+  double previous = std::numeric_limits<double>::infinity();
+
+  // первый шаг - решение с нулевым приближением, т.е. r = b
+  r.CopyMatrix(b);
+  while (ok && stats->iterations <= kRefineMaxIterations) {
+    S21CheckCancelled();
+    double step = 0.0;
+    for (int j = 0; j < m; ++j) {
+      for (int i = 0; i < n; ++i) column[i] = r.matrix_[i][j];
+      lu.Solve(correction, column);
+      for (int i = 0; i < n; ++i) {
+        x.matrix_[i][j] += correction[i];
+        step = std::fmax(step, std::fabs(correction[i]));
+      }
     }
+    stats->residual = Residual(b, x, r);
+    if (!std::isfinite(stats->residual)) break;
+    if (stats->residual <= tolerance * x.NormInf()) {
+      stats->converged = true;
+      break;
+    }
+    // уточнение застряло: шаг не уменьшился хотя бы вдвое
+    if (stats->iterations > 0 && step > 0.5 * previous) break;
+    previous = step;
+    stats->iterations++;
   }
-  return Temp;
+
+  if (!stats->converged) {
+    stats->fallback = true;
+    x = Solve(b);
+    stats->residual = Residual(b, x, r);
+  }
+  return x;
 }
 
-void S21Matrix::MulNumber(const double num) {
+// r = b - A * x, возвращает максимум модуля невязки
+double S21Matrix::Residual(const S21Matrix &b, const S21Matrix &x,
+                           S21Matrix &r) const {
+  double norm = 0.0;
   for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      matrix_[i][j] *= num;
+    for (int j = 0; j < b.cols_; ++j) {
+      double sum = b.matrix_[i][j];
+      for (int k = 0; k < cols_; ++k) sum -= matrix_[i][k] * x.matrix_[k][j];
+      r.matrix_[i][j] = sum;
+      norm = std::fmax(norm, std::fabs(sum));
     }
   }
+  return norm;
 }
 
-void S21Matrix::MulMatrix(const S21Matrix &other) {
-  if (cols_ != other.rows_) {
-    throw std::invalid_argument("\nWrong count of rows or columns\n");
+// PA = LU: L с единичной диагональю хранится под диагональю lu,
+// perm[i] - исходный номер строки, оказавшейся на месте i
+void S21Matrix::FactorizeLU(S21Matrix &lu, std::vector<int> &perm) const {
+  int n = rows_;
+  lu.CopyMatrix(*this);
+  perm.resize(n);
+  for (int i = 0; i < n; ++i) perm[i] = i;
+
+  for (int k = 0; k < n; ++k) {
+    S21CheckCancelled();
+    int pivot = k;
+    for (int i = k + 1; i < n; ++i) {
+      if (std::fabs(lu.matrix_[i][k]) > std::fabs(lu.matrix_[pivot][k])) {
+        pivot = i;
+      }
+    }
+    // порог не абсолютный: у 1e-8 * I все ведущие элементы меньше EPS, но
+    // матрица хорошо обусловлена, поэтому отвергается только точный ноль
+    double lead = lu.matrix_[pivot][k];
+    if (lead == 0.0 || !std::isfinite(lead)) {
+      throw std::logic_error("\nDeterminant value can't be equal to 0\n");
+    }
+    // строки хранятся отдельно, поэтому перестановка - это обмен указателей
+    std::swap(lu.matrix_[k], lu.matrix_[pivot]);
+    std::swap(perm[k], perm[pivot]);
+
+    for (int i = k + 1; i < n; ++i) {
+      double factor = lu.matrix_[i][k] / lu.matrix_[k][k];
+      lu.matrix_[i][k] = factor;
+      if (factor == 0.0) continue;
+      for (int j = k + 1; j < n; ++j) {
+        lu.matrix_[i][j] -= factor * lu.matrix_[k][j];
+      }
+    }
   }
-  S21Matrix Temp(rows_, other.cols_);
+}
 
-  // строки А (строки С)
-  for (int i = 0; i < rows_; i++) {
-    // столбцы B (столбцы С)
-    for (int j = 0; j < other.cols_; j++) {
-      // общий столбцы А == строки В
-      for (int k = 0; k < other.rows_; k++) {
-        Temp.matrix_[i][j] += matrix_[i][k] * other.matrix_[k][j];
+S21Matrix S21Matrix::SolveLU(const S21Matrix &lu, const std::vector<int> &perm,
+                             const S21Matrix &b) {
+  int n = lu.rows_, m = b.cols_;
+  S21Matrix x(n, m);
+  // прямой ход: L * Y = P * B
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < m; ++j) x.matrix_[i][j] = b.matrix_[perm[i]][j];
+    for (int k = 0; k < i; ++k) {
+      double factor = lu.matrix_[i][k];
+      if (factor == 0.0) continue;
+      for (int j = 0; j < m; ++j) x.matrix_[i][j] -= factor * x.matrix_[k][j];
+    }
+  }
+  // обратный ход: U * X = Y
+  for (int i = n - 1; i >= 0; --i) {
+    for (int k = i + 1; k < n; ++k) {
+      double factor = lu.matrix_[i][k];
+      for (int j = 0; j < m; ++j) x.matrix_[i][j] -= factor * x.matrix_[k][j];
+    }
+    for (int j = 0; j < m; ++j) x.matrix_[i][j] /= lu.matrix_[i][i];
+  }
+  return x;
+}
+
+// A = P^T L U, поэтому A^T X = B: U^T Z = B, L^T W = Z, X = P^T W.
+// Строки U^T и L^T - столбцы lu, поэтому вычитаются целые строки w
+S21Matrix S21Matrix::SolveLUTransposed(const S21Matrix &lu,
+                                       const std::vector<int> &perm,
+                                       const S21Matrix &b) {
+  int n = lu.rows_, m = b.cols_;
+  S21Matrix w(b);
+  w.Touch();  // w пишется напрямую, общий с b буфер нужно отделить
+  // U^T нижняя треугольная: прямой ход
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < m; ++j) w.matrix_[i][j] /= lu.matrix_[i][i];
+    for (int k = i + 1; k < n; ++k) {
+      double factor = lu.matrix_[i][k];
+      if (factor == 0.0) continue;
+      for (int j = 0; j < m; ++j) w.matrix_[k][j] -= factor * w.matrix_[i][j];
+    }
+  }
+  // L^T верхняя с единичной диагональю: обратный ход
+  for (int i = n - 1; i >= 0; --i) {
+    for (int k = 0; k < i; ++k) {
+      double factor = lu.matrix_[i][k];
+      if (factor == 0.0) continue;
+      for (int j = 0; j < m; ++j) w.matrix_[k][j] -= factor * w.matrix_[i][j];
+    }
+  }
+  S21Matrix x(n, m);
+  for (int i = 0; i < n; ++i) {
+    std::copy(w.matrix_[i], w.matrix_[i] + m, x.matrix_[perm[i]]);
+  }
+  return x;
+}
+
+// Бинарное возведение в степень: три буфера на все время работы,
+// результат и квадраты основания меняются местами через Swap
+S21Matrix S21Matrix::Pow(int k) const {
+  S21_STATS_SCOPE(S21Op::kPow, Elements(),
+                  4.0 * rows_ * Elements() * std::log2(std::fabs(k) + 1.0),
+                  48.0 * Elements() * std::log2(std::fabs(k) + 1.0));
+  if (rows_ != cols_) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  }
+  if (transposed_) {  // (A^T)^k = (A^k)^T
+    S21Matrix power = StorageView().Pow(k);
+    power.transposed_ = !power.transposed_;
+    return power;
+  }
+  if (k == 0) return Identity(rows_);
+
+  S21Matrix base = k > 0 ? S21Matrix(*this) : Solve(Identity(rows_));
+  // -k переполняется для INT_MIN, поэтому работаем с unsigned
+  unsigned int power = k > 0 ? static_cast<unsigned int>(k)
+                             : 0u - static_cast<unsigned int>(k);
+
+  S21Matrix result(rows_, cols_), temp(rows_, cols_);
+  bool empty = true;  // result пока равен единичной матрице
+  while (power) {
+    S21CheckCancelled();
+    if (power & 1u) {
+      if (empty) {
+        result.CopyMatrix(base);
+        empty = false;
+      } else {
+        MulInto(result, base, temp);
+        result.Swap(temp);
       }
     }
+    power >>= 1u;
+    if (power) {
+      MulInto(base, base, temp);
+      base.Swap(temp);
+    }
   }
-  MoveMatrix(Temp);
+  return result;
 }
 
-void S21Matrix::SumMatrix(const S21Matrix &other) {
-  if (!EqualMatrix(other)) {
-    throw std::invalid_argument("\nRows and columns do not match\n");
+// Масштабирование и возведение в квадрат с аппроксимацией Паде порядка 6
+// (Golub, Van Loan, алгоритм 11.3.1)
+S21Matrix S21Matrix::Exp() const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  }
+  if (transposed_) {  // e^(A^T) = (e^A)^T
+    S21Matrix e = StorageView().Exp();
+    e.transposed_ = !e.transposed_;
+    return e;
   }
+  const int q = 6;
+  S21_STATS_SCOPE(S21Op::kExp, Elements(),
+                  2.0 * rows_ * rows_ * cols_ * (q + 1),
+                  24.0 * rows_ * cols_ * (q + 1));
+  double norm = NormInf();
+  int s = norm > 0.5 ? static_cast<int>(std::ceil(std::log2(norm / 0.5))) : 0;
+
+  S21Matrix a(*this);
+  a.MulNumber(std::ldexp(1.0, -s));
+
+  S21Matrix x(a), temp(rows_, cols_);
+  S21Matrix n = Identity(rows_), d = Identity(rows_);
+  double c = 0.5;
   for (int i = 0; i < rows_; ++i) {
     for (int j = 0; j < cols_; ++j) {
-      matrix_[i][j] += other.matrix_[i][j];
+      n.matrix_[i][j] += c * a.matrix_[i][j];
+      d.matrix_[i][j] -= c * a.matrix_[i][j];
     }
   }
+  bool positive = true;
+  for (int k = 2; k <= q; ++k) {
+    c = c * (q - k + 1) / (k * (2 * q - k + 1));
+    MulInto(a, x, temp);
+    x.Swap(temp);
+    for (int i = 0; i < rows_; ++i) {
+      for (int j = 0; j < cols_; ++j) {
+        n.matrix_[i][j] += c * x.matrix_[i][j];
+        d.matrix_[i][j] += (positive ? c : -c) * x.matrix_[i][j];
+      }
+    }
+    positive = !positive;
+  }
+
+  S21Matrix e = d.Solve(n);
+  for (int k = 0; k < s; ++k) {
+    MulInto(e, e, temp);
+    e.Swap(temp);
+  }
+  return e;
 }
 
-void S21Matrix::SubMatrix(const S21Matrix &other) {
-  if (!EqualMatrix(other)) {
-    throw std::invalid_argument("\nRows and columns do not match\n");
+void S21Matrix::MulInto(const S21Matrix &a, const S21Matrix &b,
+                        S21Matrix &out) {
+  out.Touch();  // после Swap out может делить буфер с другой матрицей
+  for (int i = 0; i < a.rows_; i++) {
+    double *out_row = out.matrix_[i];
+    for (int j = 0; j < b.cols_; j++) out_row[j] = 0.0;
+    // порядок i-k-j: внутренний цикл идет по строкам подряд
+    for (int k = 0; k < a.cols_; k++) {
+      double a_ik = a.matrix_[i][k];
+      const double *b_row = b.matrix_[k];
+      for (int j = 0; j < b.cols_; j++) out_row[j] += a_ik * b_row[j];
+    }
   }
+}
+
+S21Matrix S21Matrix::Identity(int size) {
+  S21Matrix identity(size, size);
+  for (int i = 0; i < size; ++i) identity.matrix_[i][i] = 1.0;
+  return identity;
+}
+
+double S21Matrix::Sum(S21ExecutionPolicy policy) const {
+  return MapReduce([](double x) { return x; }, 0.0, std::plus<double>(),
+                   policy);
+}
+
+double S21Matrix::Min(S21ExecutionPolicy policy) const {
+  if (Elements() == 0) throw std::length_error("\nThe matrix is empty\n");
+  return MapReduce([](double x) { return x; },
+                   std::numeric_limits<double>::infinity(),
+                   [](double a, double b) { return std::min(a, b); }, policy);
+}
+
+double S21Matrix::Max(S21ExecutionPolicy policy) const {
+  if (Elements() == 0) throw std::length_error("\nThe matrix is empty\n");
+  return MapReduce([](double x) { return x; },
+                   -std::numeric_limits<double>::infinity(),
+                   [](double a, double b) { return std::max(a, b); }, policy);
+}
+
+double S21Matrix::Norm1(S21ExecutionPolicy policy) const {
+  return transposed_ ? RowSumNorm(policy) : ColumnSumNorm(policy);
+}
+
+double S21Matrix::NormInf(S21ExecutionPolicy policy) const {
+  return transposed_ ? ColumnSumNorm(policy) : RowSumNorm(policy);
+}
+
+// столбцы буфера суммируются построчно, чтобы идти по памяти подряд
+double S21Matrix::ColumnSumNorm(S21ExecutionPolicy policy) const {
+  auto block = [this](int r0, int r1) {
+    std::vector<double> sums(cols_, 0.0);
+    for (int i = r0; i < r1; ++i) {
+      for (int j = 0; j < cols_; ++j) sums[j] += std::fabs(matrix_[i][j]);
+    }
+    return sums;
+  };
+  auto add = [](std::vector<double> a, const std::vector<double> &b) {
+    for (std::size_t j = 0; j < a.size(); ++j) a[j] += b[j];
+    return a;
+  };
+  std::vector<double> sums = ReduceRowBlocks(
+      policy, std::vector<double>(cols_, 0.0), block, add);
+  double norm = 0.0;
+  for (double sum : sums) norm = std::max(norm, sum);
+  return norm;
+}
+
+// степенной метод для A^T A: ||A||_2 = sqrt(lambda_max(A^T A))
+double S21Matrix::Norm2() const {
+  if (Elements() == 0) return 0.0;
+  std::vector<double> v(cols_), av(rows_), w(cols_);
+  // не все единицы: такой вектор ортогонален, например, строке (1, -1)
+  for (int j = 0; j < cols_; ++j) v[j] = 1.0 + 0.618 * j / cols_;
+  double sigma = 0.0;
+  for (int iter = 0; iter < 1000; ++iter) {
+    S21CheckCancelled();
+    double norm_v = 0.0;
+    for (double x : v) norm_v += x * x;
+    norm_v = std::sqrt(norm_v);
+    if (norm_v == 0.0) return sigma;
+    for (double &x : v) x /= norm_v;
+    std::fill(av.begin(), av.end(), 0.0);
+    std::fill(w.begin(), w.end(), 0.0);
+    for (int i = 0; i < rows_; ++i) {
+      for (int j = 0; j < cols_; ++j) av[i] += matrix_[i][j] * v[j];
+    }
+    for (int i = 0; i < rows_; ++i) {
+      for (int j = 0; j < cols_; ++j) w[j] += matrix_[i][j] * av[i];
+    }
+    double norm_av = 0.0;
+    for (double x : av) norm_av += x * x;
+    double next = std::sqrt(norm_av);
+    v.swap(w);
+    if (std::fabs(next - sigma) <= 1e-14 * next) return next;
+    sigma = next;
+  }
+  return sigma;
+}
+
+double S21Matrix::RowSumNorm(S21ExecutionPolicy policy) const {
+  auto block = [this](int r0, int r1) {
+    double norm = 0.0;
+    for (int i = r0; i < r1; ++i) {
+      double sum = 0.0;
+      for (int j = 0; j < cols_; ++j) sum += std::fabs(matrix_[i][j]);
+      if (sum > norm) norm = sum;
+    }
+    return norm;
+  };
+  return ReduceRowBlocks(policy, 0.0, block,
+                         [](double a, double b) { return std::max(a, b); });
+}
+
+double S21Matrix::NormFrobenius(S21ExecutionPolicy policy) const {
+  return std::sqrt(MapReduce([](double x) { return x * x; }, 0.0,
+                             std::plus<double>(), policy));
+}
+
+double S21Matrix::Trace() const {
+  if (rows_ != cols_) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  }
+  double trace = 0.0;
+  for (int i = 0; i < rows_; ++i) trace += matrix_[i][i];
+  return trace;
+}
+
+void S21Matrix::Swap(S21Matrix &other) {
+  if (!IsInline() && !other.IsInline()) {
+    std::swap(rows_, other.rows_);
+    std::swap(cols_, other.cols_);
+    std::swap(matrix_, other.matrix_);
+    std::swap(shared_, other.shared_);
+    std::swap(external_, other.external_);
+    std::swap(transposed_, other.transposed_);
+  } else {
+    S21Matrix temp(0, 0);
+    temp.MoveMatrix(other);
+    other.MoveMatrix(*this);
+    MoveMatrix(temp);
+  }
+  std::swap(cache_, other.cache_);
+  std::swap(cow_, other.cow_);
+}
+
+void S21Matrix::EnableCache(bool enable) {
+  if (enable && !cache_) {
+    cache_ = new Cache;
+  } else if (!enable) {
+    delete cache_;
+    cache_ = nullptr;
+  }
+}
+
+bool S21Matrix::IsCacheEnabled() const { return cache_ != nullptr; }
+
+void S21Matrix::EnableCopyOnWrite(bool enable) {
+  if (enable) {
+    cow_ = true;
+    AdoptShared();
+  } else {
+    // счетчик бывает и без cow_: его заводит Transpose
+    if (shared_) Detach();
+    delete shared_;
+    shared_ = nullptr;
+    cow_ = false;
+  }
+}
+
+bool S21Matrix::IsCopyOnWrite() const { return cow_; }
+
+bool S21Matrix::IsShared() const {
+  return shared_ && shared_->refs.load(std::memory_order_acquire) > 1;
+}
+
+// Текущая матрица пуста; разделяет буфер other, если это возможно
+bool S21Matrix::ShareFrom(const S21Matrix &other) {
+  if (!other.shared_) return false;
+  other.shared_->refs.fetch_add(1, std::memory_order_relaxed);
+  shared_ = other.shared_;
+  matrix_ = other.matrix_;
+  rows_ = other.rows_;
+  cols_ = other.cols_;
+  transposed_ = other.transposed_;
+  cow_ = other.cow_;
+  return true;
+}
+
+// В режиме cow_ у буфера в куче всегда есть счетчик ссылок
+void S21Matrix::AdoptShared() {
+  if (cow_ && !shared_ && matrix_ && !IsInline() && !external_) {
+    shared_ = new Shared;
+  }
+}
+
+void S21Matrix::Detach() {
+  if (shared_->refs.load(std::memory_order_acquire) == 1) return;
+  double **block = matrix_;
+  Shared *shared = shared_;
+  shared_ = nullptr;
+  CreateMatrix();
   for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      matrix_[i][j] -= other.matrix_[i][j];
+    std::copy(block[i], block[i] + cols_, matrix_[i]);
+  }
+  // другой владелец мог отпустить буфер, пока шло копирование
+  if (shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    S21MatrixDeallocate(block, BlockBytes());
+    delete shared;
+  }
+}
+
+void S21Matrix::InvalidateCache() {
+  cache_->has_det = false;
+  cache_->lu.reset();
+  cache_->inverse.reset();
+}
+
+int S21Matrix::EqualMatrix(const S21Matrix &other) {
+  return (other.GetCols() == GetCols()) && (other.GetRows() == GetRows());
+}
+
+// Куча делится с результатом так же, как при копировании при записи: у
+// буфера появляется счетчик ссылок, и первая запись в любую из матриц
+// отделит ее копию. Встроенный и внешний буферы просто копируются
+S21Matrix S21Matrix::Transpose() {
+  S21_STATS_SCOPE(S21Op::kTranspose, Elements(), 0, 0);
+  if (!shared_ && matrix_ && !IsInline() && !external_) {
+    shared_ = new Shared;
+  }
+  S21Matrix result(*this);
+  result.transposed_ = !transposed_;
+  return result;
+}
+
+S21Matrix S21Matrix::Materialized() const {
+  return transposed_ ? FlippedStorage() : S21Matrix(*this);
+}
+
+S21Matrix S21Matrix::FlippedStorage() const {
+  S21Matrix flipped(cols_, rows_);
+  // блоками, чтобы и чтение, и запись оставались в кеше
+  const int tile = 32;
+  for (int i0 = 0; i0 < rows_; i0 += tile) {
+    for (int j0 = 0; j0 < cols_; j0 += tile) {
+      for (int i = i0; i < std::min(rows_, i0 + tile); ++i) {
+        for (int j = j0; j < std::min(cols_, j0 + tile); ++j) {
+          flipped.matrix_[j][i] = matrix_[i][j];
+        }
+      }
+    }
+  }
+  return flipped;
+}
+
+double *S21Matrix::Data() {
+  Touch();
+  return rows_ ? matrix_[0] : nullptr;
+}
+
+const double *S21Matrix::Data() const { return rows_ ? matrix_[0] : nullptr; }
+
+int S21Matrix::Stride() const { return external_ ? external_->stride : cols_; }
+
+bool S21Matrix::IsView() const { return external_ != nullptr; }
+
+S21Layout S21Matrix::GetLayout() const {
+  return transposed_ ? S21Layout::kColMajor : S21Layout::kRowMajor;
+}
+
+void S21Matrix::ConvertTo(S21Layout layout) {
+  if (layout == GetLayout()) return;
+  S21Matrix flipped = FlippedStorage();
+  flipped.transposed_ = !transposed_;
+  if (cache_) InvalidateCache();  // LU в кеше построено по старому буферу
+  MoveMatrix(flipped);
+}
+
+S21Matrix S21Matrix::InLayout(S21Layout layout) const {
+  if (layout == GetLayout()) return S21Matrix(*this);
+  S21Matrix flipped = FlippedStorage();
+  flipped.transposed_ = !transposed_;
+  return flipped;
+}
+
+// буфер матрицы в раскладке layout - ровно плотный массив в этой раскладке
+S21Matrix S21Matrix::FromBuffer(const double *data, int rows, int cols,
+                                S21Layout layout) {
+  S21Matrix m(rows, cols, layout);
+  for (int i = 0; i < m.rows_; ++i) {
+    const double *row = data + static_cast<std::size_t>(i) * m.cols_;
+    std::copy(row, row + m.cols_, m.matrix_[i]);
+  }
+  return m;
+}
+
+void S21Matrix::ToBuffer(double *data, S21Layout layout) const {
+  if (layout == GetLayout()) {
+    for (int i = 0; i < rows_; ++i) {
+      std::copy(matrix_[i], matrix_[i] + cols_,
+                data + static_cast<std::size_t>(i) * cols_);
+    }
+    return;
+  }
+  const int tile = 32;
+  for (int i0 = 0; i0 < rows_; i0 += tile) {
+    for (int j0 = 0; j0 < cols_; j0 += tile) {
+      for (int i = i0; i < std::min(rows_, i0 + tile); ++i) {
+        for (int j = j0; j < std::min(cols_, j0 + tile); ++j) {
+          data[static_cast<std::size_t>(j) * rows_ + i] = matrix_[i][j];
+        }
+      }
     }
   }
 }
 
-void S21Matrix::CopyMatrix(const S21Matrix &other) {
-  for (int i = 0; i < other.rows_; i++) {
-    for (int j = 0; j < other.cols_; j++) {
-      matrix_[i][j] = other.matrix_[i][j];
+// строка в kRowMajor и столбец в kColMajor - одна строка буфера
+S21Matrix S21Matrix::Row(int row) const {
+  if (row < 0 || row >= GetRows()) {
+    throw std::out_of_range("Index outside the matrix");
+  }
+  S21Matrix result(1, GetCols());
+  if (transposed_) {
+    for (int j = 0; j < rows_; ++j) result.matrix_[0][j] = matrix_[j][row];
+  } else {
+    std::copy(matrix_[row], matrix_[row] + cols_, result.matrix_[0]);
+  }
+  return result;
+}
+
+S21Matrix S21Matrix::Column(int col) const {
+  if (col < 0 || col >= GetCols()) {
+    throw std::out_of_range("Index outside the matrix");
+  }
+  S21Matrix result(GetRows(), 1, S21Layout::kColMajor);
+  if (transposed_) {
+    std::copy(matrix_[col], matrix_[col] + cols_, result.matrix_[0]);
+  } else {
+    for (int i = 0; i < rows_; ++i) result.matrix_[0][i] = matrix_[i][col];
+  }
+  return result;
+}
+
+void S21Matrix::ScaleRows(const std::vector<double> &factors) {
+  if (static_cast<int>(factors.size()) != GetRows()) {
+    throw std::invalid_argument("\nWrong count of factors\n");
+  }
+  Touch();
+  ScaleStorage(factors, !transposed_);
+}
+
+void S21Matrix::ScaleColumns(const std::vector<double> &factors) {
+  if (static_cast<int>(factors.size()) != GetCols()) {
+    throw std::invalid_argument("\nWrong count of factors\n");
+  }
+  Touch();
+  ScaleStorage(factors, transposed_);
+}
+
+void S21Matrix::ScaleStorage(const std::vector<double> &factors,
+                             bool by_row) {
+  for (int i = 0; i < rows_; ++i) {
+    double *row = matrix_[i];
+    if (by_row) {
+      double factor = factors[i];
+      for (int j = 0; j < cols_; ++j) row[j] *= factor;
+    } else {
+      for (int j = 0; j < cols_; ++j) row[j] *= factors[j];
+    }
+  }
+}
+
+const S21Matrix &S21Matrix::RowMajor(const S21Matrix &m, S21Matrix &storage) {
+  if (!m.transposed_) return m;
+  S21Matrix plain = m.Materialized();
+  storage.Swap(plain);
+  return storage;
+}
+
+S21Matrix S21Matrix::StorageView() const {
+  S21Matrix view(*this);
+  view.transposed_ = false;
+  return view;
+}
+
+void S21Matrix::MulNumber(const double num, S21ExecutionPolicy policy) {
+  S21_STATS_SCOPE(S21Op::kMulNumber, Elements(), Elements(), 16.0 * Elements());
+  Touch();
+  ForRowBlocks(policy, [this, num](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *row = matrix_[i];
+      for (int j = 0; j < cols_; ++j) row[j] *= num;
+    }
+  });
+}
+
+void S21Matrix::MulMatrix(const S21Matrix &other) {
+  S21_STATS_SCOPE(S21Op::kMulMatrix, Elements(),
+                  2.0 * rows_ * cols_ * other.cols_,
+                  8.0 * (Elements() + other.Elements() +
+                         int64_t(rows_) * other.cols_));
+  if (GetCols() != other.GetRows()) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  // без Touch: буфер целиком заменяется результатом, а общую ссылку
+  // отпустит MoveMatrix, так что отделять копию незачем
+  if (cache_) InvalidateCache();
+  S21Matrix Temp(GetRows(), other.GetCols());
+  Gemm(1.0, *this, false, other, false, 0.0, Temp);
+  MoveMatrix(Temp);
+}
+
+// Флаги transposed_ операндов складываются с trans_a и trans_b, так что
+// ядро работает с буферами как есть. Если транспонирован буфер c, в нем
+// считается C^T = alpha * op(b)^T * op(a)^T + beta * C^T
+void S21Matrix::Gemm(double alpha, const S21Matrix &a, bool trans_a,
+                     const S21Matrix &b, bool trans_b, double beta,
+                     S21Matrix &c, S21ExecutionPolicy policy) {
+  int m = trans_a ? a.GetCols() : a.GetRows();
+  int inner = trans_a ? a.GetRows() : a.GetCols();
+  int n = trans_b ? b.GetRows() : b.GetCols();
+  S21_STATS_SCOPE(S21Op::kGemm, int64_t(m) * n, 2.0 * m * n * inner,
+                  8.0 * (a.Elements() + b.Elements() + 2 * int64_t(m) * n));
+  if (inner != (trans_b ? b.GetCols() : b.GetRows()) || c.GetRows() != m ||
+      c.GetCols() != n) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  bool storage_a = trans_a != a.transposed_;
+  bool storage_b = trans_b != b.transposed_;
+  if (&c == &a || &c == &b) {
+    S21Matrix product(m, n);
+    GemmKernel(alpha, a, storage_a, b, storage_b, 0.0, product, policy);
+    if (beta != 0.0) product.Axpy(beta, c, policy);
+    c.Touch();
+    c.ForEachPair(product, policy, [](double &x, double y) { x = y; });
+    return;
+  }
+  c.Touch();
+  if (c.transposed_) {
+    GemmKernel(alpha, b, !storage_b, a, !storage_a, beta, c, policy);
+  } else {
+    GemmKernel(alpha, a, storage_a, b, storage_b, beta, c, policy);
+  }
+}
+
+// Все четыре варианта транспонирования идут по блокам строк c, а порядок
+// циклов выбран так, чтобы внутренний цикл читал строки подряд
+void S21Matrix::GemmKernel(double alpha, const S21Matrix &a, bool trans_a,
+                           const S21Matrix &b, bool trans_b, double beta,
+                           S21Matrix &c, S21ExecutionPolicy policy) {
+  int inner = trans_a ? a.rows_ : a.cols_;
+  int n = c.cols_;
+  c.ForRowBlocks(policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *c_row = c.matrix_[i];
+      if (beta == 0.0) {
+        std::fill(c_row, c_row + n, 0.0);
+      } else if (beta != 1.0) {
+        for (int j = 0; j < n; ++j) c_row[j] *= beta;
+      }
     }
+    if (alpha == 0.0) return;
+    if (trans_a) {
+      // строка k матрицы a дает k-й член для всех строк c блока
+      for (int k = 0; k < inner; ++k) {
+        S21CheckCancelled();
+        const double *a_row = a.matrix_[k];
+        for (int i = r0; i < r1; ++i) {
+          double *c_row = c.matrix_[i];
+          double a_ik = alpha * a_row[i];
+          if (trans_b) {
+            for (int j = 0; j < n; ++j) c_row[j] += a_ik * b.matrix_[j][k];
+          } else {
+            const double *b_row = b.matrix_[k];
+            for (int j = 0; j < n; ++j) c_row[j] += a_ik * b_row[j];
+          }
+        }
+      }
+      return;
+    }
+    for (int i = r0; i < r1; ++i) {
+      S21CheckCancelled();
+      const double *a_row = a.matrix_[i];
+      double *c_row = c.matrix_[i];
+      if (trans_b) {
+        // строка c - скалярные произведения строки a на строки b
+        for (int j = 0; j < n; ++j) {
+          const double *b_row = b.matrix_[j];
+          double dot = 0.0;
+          for (int k = 0; k < inner; ++k) dot += a_row[k] * b_row[k];
+          c_row[j] += alpha * dot;
+        }
+      } else {
+        // порядок i-k-j: внутренний цикл идет по строкам подряд
+        for (int k = 0; k < inner; ++k) {
+          double a_ik = alpha * a_row[k];
+          const double *b_row = b.matrix_[k];
+          for (int j = 0; j < n; ++j) c_row[j] += a_ik * b_row[j];
+        }
+      }
+    }
+  });
+}
+
+void S21Matrix::Axpy(double alpha, const S21Matrix &x,
+                     S21ExecutionPolicy policy) {
+  S21_STATS_SCOPE(S21Op::kAxpy, Elements(), 2 * Elements(), 24.0 * Elements());
+  if (!EqualMatrix(x)) {
+    throw std::invalid_argument("\nRows and columns do not match\n");
   }
+  Touch();
+  ForEachPair(x, policy, [alpha](double &y, double x) { y += alpha * x; });
+}
+
+void S21Matrix::SumMatrix(const S21Matrix &other, S21ExecutionPolicy policy) {
+  S21_STATS_SCOPE(S21Op::kSumMatrix, Elements(), Elements(), 24.0 * Elements());
+  if (!EqualMatrix(other)) {
+    throw std::invalid_argument("\nRows and columns do not match\n");
+  }
+  Touch();
+  ForEachPair(other, policy, [](double &x, double y) { x += y; });
+}
+
+void S21Matrix::SubMatrix(const S21Matrix &other, S21ExecutionPolicy policy) {
+  S21_STATS_SCOPE(S21Op::kSubMatrix, Elements(), Elements(), 24.0 * Elements());
+  if (!EqualMatrix(other)) {
+    throw std::invalid_argument("\nRows and columns do not match\n");
+  }
+  Touch();
+  ForEachPair(other, policy, [](double &x, double y) { x -= y; });
+}
+
+void S21Matrix::CopyMatrix(const S21Matrix &other, S21ExecutionPolicy policy) {
+  other.ForRowBlocks(policy, [this, &other](int r0, int r1) {
+    for (int i = r0; i < r1; i++) {
+      std::copy(other.matrix_[i], other.matrix_[i] + other.cols_, matrix_[i]);
+    }
+  });
 }
 
 void S21Matrix::MoveMatrix(S21Matrix &other) {
-  matrix_ = other.matrix_;
+  DestroyMatrix();
   rows_ = other.rows_;
   cols_ = other.cols_;
-  other.matrix_ = nullptr;
+  transposed_ = other.transposed_;
+  if (other.IsInline()) {  // встроенный буфер не передать, только скопировать
+    CreateMatrix();
+    CopyMatrix(other);
+  } else {
+    matrix_ = other.matrix_;
+    shared_ = other.shared_;
+    external_ = other.external_;
+  }
+  other.SetNull();
+  AdoptShared();
 }
 
-void S21Matrix::CreateMatrix() {
-  matrix_ = new double *[rows_]();
+// Один блок: сначала указатели на строки, за ними элементы подряд.
+// Маленькие матрицы (до 4x4) помещаются во встроенный буфер без кучи.
+void S21Matrix::CreateMatrix(S21ExecutionPolicy policy) {
+  AllocateMatrix();
+  ForRowBlocks(policy, [this](int r0, int r1) {
+    std::fill(matrix_[r0], matrix_[r0] + int64_t(r1 - r0) * cols_, 0.0);
+  });
+  AdoptShared();
+}
+
+void S21Matrix::AllocateMatrix() {
+  if (rows_ < 0 || cols_ < 0) {
+    throw std::bad_array_new_length();
+  }
+  if (BlockBytes() <= sizeof(inline_)) {
+    matrix_ = reinterpret_cast<double **>(inline_);
+  } else {
+    matrix_ = static_cast<double **>(S21MatrixAllocate(BlockBytes()));
+  }
+  double *data = reinterpret_cast<double *>(matrix_ + rows_);
   for (int i = 0; i < rows_; i++) {
-    matrix_[i] = new double[cols_]();
+    matrix_[i] = data + static_cast<std::size_t>(i) * cols_;
   }
 }
 
 void S21Matrix::DestroyMatrix() {
-  if (matrix_) {
-    for (int i = 0; i < rows_; i++) {
-      if (matrix_[i]) delete[] matrix_[i];
+  // общий буфер освобождает последний владелец
+  if (shared_) {
+    if (shared_->refs.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+      matrix_ = nullptr;
+    } else {
+      delete shared_;
     }
-    delete[] matrix_;
+    shared_ = nullptr;
+  }
+  if (matrix_ && !IsInline()) {
+    S21MatrixDeallocate(matrix_, BlockBytes());
+  }
+  if (external_) {
+    if (external_->deleter) external_->deleter(external_->data);
+    delete external_;
+    external_ = nullptr;
   }
   rows_ = 0;
   cols_ = 0;
   matrix_ = nullptr;
+  transposed_ = false;
 }
 
-int S21Matrix::GetRows() const { return rows_; }
+int S21Matrix::GetRows() const { return transposed_ ? cols_ : rows_; }
 
-int S21Matrix::GetCols() const { return cols_; }
+int S21Matrix::GetCols() const { return transposed_ ? rows_ : cols_; }
 
 void S21Matrix::SetRows(int rows) {
   if (rows < 1) {
     throw std::invalid_argument("\nThere must be more than 1 rows\n");
   }
+  Materialize();
   S21Matrix tempM(rows, cols_);
 
   for (int i = 0; i < ((rows_ < rows) ? rows_ : rows); i++) {
@@ -309,6 +1386,7 @@ void S21Matrix::SetColumns(int columns) {
   if (columns < 1) {
     throw std::invalid_argument("\nThere must be more than 1 columns\n");
   }
+  Materialize();
   S21Matrix tmpMatrix(rows_, columns);
   for (int i = 0; i < rows_; ++i) {
     for (int j = 0; j < columns; ++j) {
@@ -325,25 +1403,55 @@ void S21Matrix::SetColumns(int columns) {
   cols_ = columns;
   CreateMatrix();
   CopyMatrix(tmpMatrix);
+  Touch();
   tmpMatrix.~S21Matrix();
 }
 
-bool S21Matrix::EqMatrix(const S21Matrix &other) const {
+bool S21Matrix::EqMatrix(const S21Matrix &other,
+                         S21ExecutionPolicy policy) const {
+  S21_STATS_SCOPE(S21Op::kEqMatrix, Elements(), Elements(), 16.0 * Elements());
   bool result = true;
   if (matrix_ == nullptr || other.matrix_ == nullptr) {
     throw std::length_error("Matrix doesn't exist");
   }
-  if (rows_ != other.rows_ || cols_ != other.cols_) {
+  if (GetRows() != other.GetRows() || GetCols() != other.GetCols()) {
     result = false;
   }
-  for (int i = 0; i < rows_ && result == true; i++) {
-    for (int j = 0; j < cols_ && result == true; j++) {
-      if (fabs(matrix_[i][j] - other.matrix_[i][j]) > EPS) {
-        result = false;
+  if (!result) return result;
+  // блоки бросают работу, как только расхождение нашел любой из них
+  std::atomic<bool> differ{false};
+  bool same = transposed_ == other.transposed_;
+  ForRowBlocks(policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1 && !differ.load(std::memory_order_relaxed);
+         i++) {
+      const double *row = matrix_[i];
+      if (!same) {  // другая раскладка: строка буфера против столбца other
+        for (int j = 0; j < cols_; j++) {
+          if (fabs(row[j] - other.matrix_[j][i]) > EPS) {
+            differ.store(true, std::memory_order_relaxed);
+            break;
+          }
+        }
+        continue;
+      }
+      const double *other_row = other.matrix_[i];
+      if (policy == S21ExecutionPolicy::kParUnseq) {
+        bool bad = false;
+        for (int j = 0; j < cols_; j++) {
+          bad |= std::fabs(row[j] - other_row[j]) > EPS;
+        }
+        if (bad) differ.store(true, std::memory_order_relaxed);
+      } else {
+        for (int j = 0; j < cols_; j++) {
+          if (fabs(row[j] - other_row[j]) > EPS) {
+            differ.store(true, std::memory_order_relaxed);
+            break;
+          }
+        }
       }
     }
-  }
-  return result;
+  });
+  return !differ.load();
 }
 
 // void S21Matrix::PrintMatrix(){
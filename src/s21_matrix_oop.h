@@ -1,33 +1,160 @@
 #ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_OOP_H
 #define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_OOP_H
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "s21_bigint.h"
+#include "s21_thread_pool.h"
 
 #define EPS 1e-7
 #define S_AR 1
+#define S21_SBO_BYTES 160  // встроенный буфер: 4x4 и меньше без кучи
+#define S21_PARALLEL_DET_MIN 8  // с этого порядка миноры считаются в пуле
+// меньшие матрицы обрабатываются в одном потоке при любой политике
+#define S21_PARALLEL_MIN_ELEMENTS (1 << 15)
+
+class S21Matrix;
+
+// Раскладка буфера: по строкам (как в C) или по столбцам (как в Fortran).
+// По столбцам матрица хранится как транспонированный буфер по строкам
+enum class S21Layout { kRowMajor, kColMajor };
+
+// Обработчики завершения асинхронных операций: при ошибке или отмене
+// error содержит исключение, а result - значение по умолчанию. Исключение,
+// брошенное самим обработчиком, перехватывается в пуле и теряется
+using S21MatrixCallback =
+    std::function<void(S21Matrix result, std::exception_ptr error)>;
+using S21DoubleCallback =
+    std::function<void(double result, std::exception_ptr error)>;
+// Освобождает внешний буфер, когда матрица-представление разрушается
+using S21BufferDeleter = std::function<void(double *data)>;
+
+// Статистика SolveRefined
+struct S21RefineStats {
+  int iterations = 0;     // число шагов уточнения
+  bool converged = false;  // уточнение во float сошлось до точности double
+  bool fallback = false;   // пришлось решать обычным Solve в double
+  double residual = 0.0;   // ||B - A * X|| по максимуму строк
+};
 
 class S21Matrix {
  public:
   // конструкторы деструкторы
   S21Matrix();
   S21Matrix(int rows, int cols);
+  // при параллельной политике строки зануляются теми потоками, что будут
+  // их обрабатывать, и страницы достаются узлам NUMA этих потоков
+  S21Matrix(int rows, int cols, S21ExecutionPolicy policy);
+  S21Matrix(int rows, int cols, S21Layout layout);
+  // Представление над внешним буфером без копирования: строка i буфера
+  // начинается с data + i * stride (в kColMajor так же идут столбцы).
+  // Запись через матрицу меняет буфер. deleter, если задан, вызывается при
+  // разрушении или переназначении матрицы; если конструктор бросил
+  // исключение, буфер остается у вызывающего. Копия представления -
+  // обычная матрица со своим буфером.
+  S21Matrix(double *data, int rows, int cols, int stride,
+            S21BufferDeleter deleter = nullptr);
+  S21Matrix(double *data, int rows, int cols, int stride, S21Layout layout,
+            S21BufferDeleter deleter = nullptr);
   S21Matrix(S21Matrix &&other);  // конструктор перемещения
   S21Matrix(const S21Matrix &other);  // конструктор копирования
+  S21Matrix(const S21Matrix &other, S21ExecutionPolicy policy);
   ~S21Matrix();
 
   // методы
-  bool EqMatrix(const S21Matrix &other) const;
-  void SumMatrix(const S21Matrix &other);
-  void SubMatrix(const S21Matrix &other);
-  void MulNumber(const double num);        // умножение на число
+  bool EqMatrix(const S21Matrix &other,
+                S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  void SumMatrix(const S21Matrix &other,
+                 S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+  void SubMatrix(const S21Matrix &other,
+                 S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+  void MulNumber(const double num,
+                 S21ExecutionPolicy policy =
+                     S21ExecutionPolicy::kSeq);  // умножение на число
   void MulMatrix(const S21Matrix &other);  // умножение матриц
+  // O(1): результат делит буфер с исходной матрицей и помечен как
+  // транспонированный, все операции читают такой буфер по столбцам.
+  // Копию отделяет первый изменяющий вызов любой из двух матриц; запись
+  // через указатель из Data() или ссылку из operator(), полученные до
+  // Transpose, мимо этих вызовов попадет и в результат
   S21Matrix Transpose();
   S21Matrix CalcComplements();  // Вычисляет матрицу алгебраических дополнений
                                 // текущей матрицы и возвращает ее
   S21Matrix Submatrix(int row, int col);
   double Determinant();  // Вычисляет и возвращает определитель текущей матрицы
+  // точный определитель целочисленной матрицы методом Барейса за O(n^3)
+  S21BigInt DeterminantExact() const;
   S21Matrix InverseMatrix();  // Вычисляет и возвращает обратную матрицу
+  S21Matrix Solve(const S21Matrix &b) const;  // решает систему A * X = B
+  // разложение во float, невязки в double, уточнение до точности double
+  S21Matrix SolveRefined(const S21Matrix &b,
+                         S21RefineStats *stats = nullptr) const;
+  S21Matrix Pow(int k) const;  // возведение в степень (k < 0 через обратную)
+  S21Matrix Exp() const;       // матричная экспонента e^A
+
+  // c = alpha * op(a) * op(b) + beta * c, op(x) - x или x^T без копии.
+  // При beta == 0 прежнее содержимое c не читается. c может совпадать с a
+  // или b, тогда произведение считается во временную матрицу
+  static void Gemm(double alpha, const S21Matrix &a, bool trans_a,
+                   const S21Matrix &b, bool trans_b, double beta, S21Matrix &c,
+                   S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+  void Axpy(double alpha, const S21Matrix &x,  // this += alpha * x
+            S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+
+  // Поэлементные операции по буферу без проверок границ: f встраивается
+  // и цикл векторизуется. При параллельной политике f вызывается из
+  // нескольких потоков одновременно
+  template <typename F>  // a(i, j) = f(a(i, j))
+  void Apply(F f, S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+  template <typename F>  // a(i, j) = f(a(i, j), other(i, j))
+  void ZipWith(const S21Matrix &other, F f,
+               S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+  // Свертка reduce(init, map(a(0, 0)), ...) за один проход, init входит
+  // один раз. Параллельно блоки строк сворачиваются независимо и
+  // объединяются по порядку, поэтому результат не зависит от числа потоков
+  template <typename T, typename Map, typename Reduce>
+  T MapReduce(Map map, T init, Reduce reduce,
+              S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  double Sum(S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  // Min и Max пустой матрицы бросают std::length_error
+  double Min(S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  double Max(S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  // максимум сумм модулей по столбцам
+  double Norm1(S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  double Norm2() const;  // спектральная: наибольшее сингулярное число
+  // максимум сумм модулей по строкам
+  double NormInf(S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  double NormFrobenius(
+      S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  double Trace() const;
+
+  // асинхронные варианты: работают с копиями операндов в пуле
+  // S21ThreadPool::Default(), отмена через token прерывает длинные циклы
+  std::future<S21Matrix> MulMatrixAsync(
+      const S21Matrix &other, S21CancelToken token = S21CancelToken()) const;
+  std::future<S21Matrix> InverseAsync(
+      S21CancelToken token = S21CancelToken()) const;
+  std::future<double> DeterminantAsync(
+      S21CancelToken token = S21CancelToken()) const;
+  std::future<S21Matrix> SolveAsync(
+      const S21Matrix &b, S21CancelToken token = S21CancelToken()) const;
+  void MulMatrixAsync(const S21Matrix &other, S21MatrixCallback done,
+                      S21CancelToken token = S21CancelToken()) const;
+  void InverseAsync(S21MatrixCallback done,
+                    S21CancelToken token = S21CancelToken()) const;
+  void DeterminantAsync(S21DoubleCallback done,
+                        S21CancelToken token = S21CancelToken()) const;
+  void SolveAsync(const S21Matrix &b, S21MatrixCallback done,
+                  S21CancelToken token = S21CancelToken()) const;
 
   // операторы
   S21Matrix operator+(const S21Matrix &other);
@@ -41,7 +168,8 @@ class S21Matrix {
   S21Matrix &operator*=(double num);
   S21Matrix operator*(const S21Matrix &other);
   S21Matrix operator*(const double num);
-  double &operator()(int rows, int columns);
+  double &operator()(int rows, int columns);  // сбрасывает кеш
+  double operator()(int rows, int columns) const;  // чтение без сброса кеша
 
   // ассесоры мутаторы
   int GetRows() const;
@@ -50,19 +178,214 @@ class S21Matrix {
   void SetRows(int rows);
   void SetColumns(int columns);
 
+  // Раскладка. ConvertTo ничего не делает, если раскладка уже нужная,
+  // иначе переписывает буфер блоками; кеш LU при этом сбрасывается
+  S21Layout GetLayout() const;
+  void ConvertTo(S21Layout layout);
+  S21Matrix InLayout(S21Layout layout) const;  // копия в нужной раскладке
+  // m, если она уже kRowMajor, иначе ее копия в storage: ядрам, которым
+  // нужны строки подряд, копия нужна только для kColMajor
+  static const S21Matrix &RowMajor(const S21Matrix &m, S21Matrix &storage);
+  // Первый элемент буфера в раскладке GetLayout(); соседние строки буфера
+  // отстоят на Stride() элементов. Неконстантный Data() сбрасывает кеш и
+  // отделяет общий буфер, как любой изменяющий метод. Указатель остается
+  // в буфере, даже если потом его разделят Transpose или копия с
+  // EnableCopyOnWrite: перед записью через него Data() вызывается заново
+  double *Data();
+  const double *Data() const;
+  int Stride() const;
+  bool IsView() const;  // матрица построена над внешним буфером
+  // обмен с внешним плотным буфером rows x cols в заданной раскладке:
+  // при совпадении раскладок копируются целые строки буфера
+  static S21Matrix FromBuffer(const double *data, int rows, int cols,
+                              S21Layout layout);
+  void ToBuffer(double *data, S21Layout layout) const;
+
+  // срезы и масштабирование; по строкам быстрее в kRowMajor, по столбцам -
+  // в kColMajor, где столбец лежит в памяти подряд
+  S21Matrix Row(int row) const;     // 1 x cols
+  S21Matrix Column(int col) const;  // rows x 1
+  void ScaleRows(const std::vector<double> &factors);
+  void ScaleColumns(const std::vector<double> &factors);
+
+  // Кеш определителя, LU-разложения и обратной матрицы. Любой изменяющий
+  // метод и неконстантный operator() сбрасывают его, поэтому при включенном
+  // кеше элементы стоит читать через константную ссылку.
+  void EnableCache(bool enable);
+  bool IsCacheEnabled() const;
+
+  // Копирование при записи: копии такой матрицы делят с ней буфер (счетчик
+  // ссылок атомарный), а настоящая копия делается при первой записи.
+  // Копии наследуют режим. Матрицы во встроенном буфере копируются всегда.
+  void EnableCopyOnWrite(bool enable);
+  bool IsCopyOnWrite() const;
+  bool IsShared() const;  // буфер сейчас используется несколькими матрицами
+
   friend S21Matrix operator*(double num, S21Matrix &other);
+  friend class S21MatrixInverse;
   // void PrintMatrix();
 
  private:
+  struct Cache;
+  struct Shared;
+  struct External;
+
   int rows_, cols_;
   double **matrix_;
-  void CreateMatrix();
+  Cache *cache_ = nullptr;  // nullptr, пока кеш выключен
+  bool cow_ = false;
+  // в буфере rows_ x cols_ лежит A^T: логический размер cols_ x rows_
+  bool transposed_ = false;
+  // счетчик ссылок буфера в режиме cow_; mutable, потому что копирование
+  // константной матрицы начинает совместное владение
+  mutable Shared *shared_ = nullptr;
+  // внешний буфер: в куче только таблица строк, общим он не бывает
+  External *external_ = nullptr;
+  alignas(double) unsigned char inline_[S21_SBO_BYTES];
+  void CreateMatrix(S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+  void AllocateMatrix();  // блок и указатели строк, без заполнения
   void DestroyMatrix();
-  void CopyMatrix(const S21Matrix &other);  // копирует матрицу в текущий объект
+  // копирует матрицу в текущий объект
+  void CopyMatrix(const S21Matrix &other,
+                  S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
   void MoveMatrix(
       S21Matrix &other);  // перемещает, в целом как конструктор перемещ
   void SetNull();  // зануляет все, без освобождения памяти
+  void Swap(S21Matrix &other);  // обмен содержимым без копирования
+  static S21Matrix Identity(int size);
+  S21Matrix Materialized() const;  // копия без флага transposed_
+  void Materialize() { ConvertTo(S21Layout::kRowMajor); }
+  // буфер транспонированной раскладки: transposed_ ? A : A^T
+  S21Matrix FlippedStorage() const;
+  // factors[i] умножает строку i буфера (by_row) или столбец i буфера
+  void ScaleStorage(const std::vector<double> &factors, bool by_row);
+  S21Matrix StorageView() const;  // буфер как есть, без флага
+  // Gemm по буферам: флаги transposed_ уже учтены в trans_a и trans_b
+  static void GemmKernel(double alpha, const S21Matrix &a, bool trans_a,
+                         const S21Matrix &b, bool trans_b, double beta,
+                         S21Matrix &c, S21ExecutionPolicy policy);
+  double RowSumNorm(S21ExecutionPolicy policy) const;
+  double ColumnSumNorm(S21ExecutionPolicy policy) const;
+  static void MulInto(const S21Matrix &a, const S21Matrix &b,
+                      S21Matrix &out);  // out = a * b, out не совпадает с a, b
+  double CofactorDeterminant();  // разложение по первой строке, n >= 1
+  int64_t Elements() const { return int64_t(rows_) * cols_; }
+  // body(r0, r1) для блоков строк: целиком в этом потоке или в пуле
+  template <typename Body>
+  void ForRowBlocks(S21ExecutionPolicy policy, Body body) const {
+    if (rows_ == 0) return;
+    if (policy == S21ExecutionPolicy::kSeq ||
+        Elements() < S21_PARALLEL_MIN_ELEMENTS) {
+      body(0, rows_);
+      return;
+    }
+    S21ParallelFor(0, rows_, std::max(1, S21_PARALLEL_MIN_ELEMENTS / cols_),
+                   body);
+  }
+  // f(x, y) для соответствующих элементов этой матрицы и other одного
+  // логического размера; при разных флагах other читается по столбцам
+  template <typename F>
+  void ForEachPair(const S21Matrix &other, S21ExecutionPolicy policy, F f) {
+    bool same = transposed_ == other.transposed_;
+    ForRowBlocks(policy, [this, &other, &f, same](int r0, int r1) {
+      for (int i = r0; i < r1; ++i) {
+        double *row = matrix_[i];
+        if (same) {
+          const double *other_row = other.matrix_[i];
+          for (int j = 0; j < cols_; ++j) f(row[j], other_row[j]);
+        } else {
+          for (int j = 0; j < cols_; ++j) f(row[j], other.matrix_[j][i]);
+        }
+      }
+    });
+  }
+  // свертка результатов block(r0, r1) по блокам строк, блоки фиксированы
+  template <typename T, typename Block, typename Reduce>
+  T ReduceRowBlocks(S21ExecutionPolicy policy, T init, Block block,
+                    Reduce reduce) const;
+  bool IsInline() const {
+    return reinterpret_cast<const unsigned char *>(matrix_) == inline_;
+  }
+  std::size_t BlockBytes() const {
+    return rows_ * sizeof(double *) +
+           (external_ ? 0 : Elements() * sizeof(double));
+  }
+  void FactorizeLU(S21Matrix &lu, std::vector<int> &perm) const;
+  static S21Matrix SolveLU(const S21Matrix &lu, const std::vector<int> &perm,
+                           const S21Matrix &b);
+  static S21Matrix SolveLUTransposed(const S21Matrix &lu,
+                                     const std::vector<int> &perm,
+                                     const S21Matrix &b);
+  double Residual(const S21Matrix &b, const S21Matrix &x, S21Matrix &r) const;
+  void InvalidateCache();
+  bool ShareFrom(const S21Matrix &other);
+  void AdoptShared();
+  void Detach();  // своя копия буфера, если он общий
+  void Touch() {  // вызывается на каждом пути изменения элементов
+    if (cache_) InvalidateCache();
+    if (shared_) Detach();
+  }
   int EqualMatrix(const S21Matrix &other);
 };
 
+template <typename F>
+void S21Matrix::Apply(F f, S21ExecutionPolicy policy) {
+  Touch();
+  ForRowBlocks(policy, [this, &f](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *row = matrix_[i];
+      for (int j = 0; j < cols_; ++j) row[j] = f(row[j]);
+    }
+  });
+}
+
+template <typename F>
+void S21Matrix::ZipWith(const S21Matrix &other, F f,
+                        S21ExecutionPolicy policy) {
+  if (!EqualMatrix(other)) {
+    throw std::invalid_argument("\nRows and columns do not match\n");
+  }
+  Touch();
+  ForEachPair(other, policy, [&f](double &x, double y) { x = f(x, y); });
+}
+
+template <typename T, typename Map, typename Reduce>
+T S21Matrix::MapReduce(Map map, T init, Reduce reduce,
+                       S21ExecutionPolicy policy) const {
+  if (Elements() == 0) return init;
+  // блок начинается со своего первого элемента, а не с init
+  auto block = [this, &map, &reduce](int r0, int r1) {
+    T acc = map(matrix_[r0][0]);
+    for (int i = r0; i < r1; ++i) {
+      const double *row = matrix_[i];
+      for (int j = i == r0 ? 1 : 0; j < cols_; ++j) {
+        acc = reduce(acc, map(row[j]));
+      }
+    }
+    return acc;
+  };
+  return ReduceRowBlocks(policy, init, block, reduce);
+}
+
+template <typename T, typename Block, typename Reduce>
+T S21Matrix::ReduceRowBlocks(S21ExecutionPolicy policy, T init, Block block,
+                             Reduce reduce) const {
+  if (rows_ == 0) return init;
+  if (policy == S21ExecutionPolicy::kSeq ||
+      Elements() < S21_PARALLEL_MIN_ELEMENTS) {
+    return reduce(init, block(0, rows_));
+  }
+  int grain = std::max(1, S21_PARALLEL_MIN_ELEMENTS / cols_);
+  int blocks = (rows_ + grain - 1) / grain;
+  std::vector<T> partial(blocks);
+  S21ParallelFor(0, blocks, 1, [&](int b0, int b1) {
+    for (int b = b0; b < b1; ++b) {
+      partial[b] = block(b * grain, std::min(rows_, (b + 1) * grain));
+    }
+  });
+  T result = init;
+  for (T &value : partial) result = reduce(result, value);
+  return result;
+}
+
 #endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_OOP_H
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "s21_matrix_pool.h"
+
+#include <mutex>
+#include <new>
+
+namespace {
+
+const int kMinClassLog = 6;   // 64 Б
+const int kMaxClassLog = 20;  // 1 МБ
+const int kClasses = kMaxClassLog - kMinClassLog + 1;
+const int kThreadCacheLimit = 64;  // блоков одного класса в кеше потока
+const std::size_t kAlign = alignof(std::max_align_t);
+
+// Свободные блоки связаны в список через свое же начало
+struct FreeBlock {
+  FreeBlock *next;
+};
+
+struct FreeList {
+  FreeBlock *head = nullptr;
+  int count = 0;
+
+  void Push(void *ptr) {
+    FreeBlock *block = static_cast<FreeBlock *>(ptr);
+    block->next = head;
+    head = block;
+    ++count;
+  }
+  void *Pop() {
+    FreeBlock *block = head;
+    head = block->next;
+    --count;
+    return block;
+  }
+};
+
+int SizeClass(std::size_t bytes) {
+  int size_class = 0;
+  std::size_t size = std::size_t(1) << kMinClassLog;
+  while (size < bytes && size_class < kClasses) {
+    size <<= 1;
+    ++size_class;
+  }
+  return size_class;
+}
+
+std::size_t ClassBytes(int size_class) {
+  return std::size_t(1) << (size_class + kMinClassLog);
+}
+
+// Общее хранилище, куда потоки сбрасывают излишки и кеш при завершении.
+// Не уничтожается, чтобы матрицы из статических объектов могли
+// освобождаться после выхода из main.
+struct Depot {
+  std::mutex mutex;
+  FreeList lists[kClasses];
+};
+
+Depot &GetDepot() {
+  static Depot *depot = new Depot;
+  return *depot;
+}
+
+struct ThreadCache {
+  FreeList lists[kClasses];
+  bool alive = true;
+
+  ~ThreadCache() {
+    Depot &depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    for (int i = 0; i < kClasses; ++i) {
+      while (lists[i].count) depot.lists[i].Push(lists[i].Pop());
+    }
+    alive = false;
+  }
+};
+
+thread_local ThreadCache thread_cache;
+
+void *PoolAllocate(std::size_t bytes, void *) {
+  int size_class = SizeClass(bytes);
+  if (size_class == kClasses || !thread_cache.alive) {
+    return ::operator new(size_class == kClasses ? bytes
+                                                 : ClassBytes(size_class));
+  }
+  FreeList &local = thread_cache.lists[size_class];
+  if (!local.count) {
+    Depot &depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    FreeList &shared = depot.lists[size_class];
+    while (shared.count && local.count < kThreadCacheLimit / 2) {
+      local.Push(shared.Pop());
+    }
+  }
+  return local.count ? local.Pop() : ::operator new(ClassBytes(size_class));
+}
+
+void PoolDeallocate(void *ptr, std::size_t bytes, void *) {
+  int size_class = SizeClass(bytes);
+  if (size_class == kClasses || !thread_cache.alive) {
+    ::operator delete(ptr);
+    return;
+  }
+  FreeList &local = thread_cache.lists[size_class];
+  if (local.count >= kThreadCacheLimit) {
+    Depot &depot = GetDepot();
+    std::lock_guard<std::mutex> lock(depot.mutex);
+    while (local.count > kThreadCacheLimit / 2) {
+      depot.lists[size_class].Push(local.Pop());
+    }
+  }
+  local.Push(ptr);
+}
+
+thread_local S21MatrixArena *current_arena = nullptr;
+thread_local bool arena_suspended = false;
+
+std::size_t AlignUp(std::size_t bytes) {
+  return (bytes + kAlign - 1) / kAlign * kAlign;
+}
+
+}  // namespace
+
+S21MatrixAllocator S21PoolMatrixAllocator() {
+  return {PoolAllocate, PoolDeallocate, nullptr};
+}
+
+void S21MatrixPoolTrim() {
+  for (int i = 0; i < kClasses; ++i) {
+    while (thread_cache.lists[i].count) {
+      ::operator delete(thread_cache.lists[i].Pop());
+    }
+  }
+  Depot &depot = GetDepot();
+  std::lock_guard<std::mutex> lock(depot.mutex);
+  for (int i = 0; i < kClasses; ++i) {
+    while (depot.lists[i].count) ::operator delete(depot.lists[i].Pop());
+  }
+}
+
+S21MatrixArena::S21MatrixArena(std::size_t chunk_bytes)
+    : cursor_(nullptr),
+      end_(nullptr),
+      chunk_bytes_(AlignUp(chunk_bytes ? chunk_bytes : S21_ARENA_CHUNK)),
+      used_(0),
+      previous_(current_arena) {
+  current_arena = this;
+}
+
+S21MatrixArena::~S21MatrixArena() {
+  current_arena = previous_;
+  for (const Chunk &chunk : chunks_) ::operator delete(chunk.begin);
+}
+
+std::size_t S21MatrixArena::BytesUsed() const { return used_; }
+
+void *S21MatrixArena::Allocate(std::size_t bytes) {
+  return current_arena && !arena_suspended ? current_arena->Bump(bytes)
+                                           : nullptr;
+}
+
+bool S21MatrixArena::Release(const void *ptr) {
+  for (const S21MatrixArena *arena = current_arena; arena;
+       arena = arena->previous_) {
+    if (arena->Owns(ptr)) return true;
+  }
+  return false;
+}
+
+void *S21MatrixArena::Bump(std::size_t bytes) {
+  bytes = AlignUp(bytes ? bytes : 1);
+  if (static_cast<std::size_t>(end_ - cursor_) < bytes) {
+    // куски растут вдвое, чтобы их оставалось немного для Owns
+    std::size_t size = chunk_bytes_;
+    if (!chunks_.empty()) size = chunks_.back().size * 2;
+    if (size < bytes) size = bytes;
+    char *begin = static_cast<char *>(::operator new(size));
+    chunks_.push_back({begin, size});
+    cursor_ = begin;
+    end_ = begin + size;
+  }
+  void *ptr = cursor_;
+  cursor_ += bytes;
+  used_ += bytes;
+  return ptr;
+}
+
+bool S21MatrixArena::Owns(const void *ptr) const {
+  const char *address = static_cast<const char *>(ptr);
+  for (const Chunk &chunk : chunks_) {
+    if (address >= chunk.begin && address < chunk.begin + chunk.size) {
+      return true;
+    }
+  }
+  return false;
+}
+
+S21MatrixArenaSuspend::S21MatrixArenaSuspend() : previous_(arena_suspended) {
+  arena_suspended = true;
+}
+
+S21MatrixArenaSuspend::~S21MatrixArenaSuspend() {
+  arena_suspended = previous_;
+}
@@ -0,0 +1,73 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_POOL_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "s21_matrix_alloc.h"
+
+#define S21_ARENA_CHUNK (64 * 1024)
+
+// Пул блоков по классам размеров (степени двойки от 64 Б до 1 МБ) с
+// кешем свободных блоков в каждом потоке. Устанавливается через
+// S21SetMatrixAllocator(S21PoolMatrixAllocator()).
+S21MatrixAllocator S21PoolMatrixAllocator();
+// отдает в систему блоки из кеша текущего потока и общего хранилища
+void S21MatrixPoolTrim();
+
+// Пока объект жив, все матрицы текущего потока получают память
+// сдвигом указателя в его кусках, а освобождение ничего не делает.
+// Вся память возвращается разом в деструкторе, поэтому матрицы,
+// созданные внутри области, не должны ее пережить или уйти в другой поток.
+//
+//   {
+//     S21MatrixArena scope;
+//     S21Matrix c = a + b * a;  // временные матрицы без обращений к new
+//     result = c.Determinant();
+//   }
+class S21MatrixArena {
+ public:
+  explicit S21MatrixArena(std::size_t chunk_bytes = S21_ARENA_CHUNK);
+  ~S21MatrixArena();
+  S21MatrixArena(const S21MatrixArena &) = delete;
+  S21MatrixArena &operator=(const S21MatrixArena &) = delete;
+
+  std::size_t BytesUsed() const;
+
+  // память из самой вложенной арены потока или nullptr, если арены нет
+  static void *Allocate(std::size_t bytes);
+  // true, если ptr выделен одной из активных арен потока
+  static bool Release(const void *ptr);
+
+ private:
+  struct Chunk {
+    char *begin;
+    std::size_t size;
+  };
+
+  std::vector<Chunk> chunks_;
+  char *cursor_;
+  char *end_;
+  std::size_t chunk_bytes_;
+  std::size_t used_;
+  S21MatrixArena *previous_;
+
+  void *Bump(std::size_t bytes);
+  bool Owns(const void *ptr) const;
+};
+
+// Пока объект жив, новые матрицы потока не берут память из его арен:
+// так создаются матрицы, которые уйдут в другой поток. Освобождение
+// блоков самих арен продолжает работать
+class S21MatrixArenaSuspend {
+ public:
+  S21MatrixArenaSuspend();
+  ~S21MatrixArenaSuspend();
+  S21MatrixArenaSuspend(const S21MatrixArenaSuspend &) = delete;
+  S21MatrixArenaSuspend &operator=(const S21MatrixArenaSuspend &) = delete;
+
+ private:
+  bool previous_;
+};
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_POOL_H
@@ -0,0 +1,205 @@
+#include "s21_matrix_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Счетчики одного потока. Пишет в них только владелец, поэтому вместо
+// атомарного сложения хватает load + store, а atomic нужен лишь для того,
+// чтобы снимок из другого потока читал целые значения.
+struct Counter {
+  std::atomic<uint64_t> value{0};
+
+  void Add(uint64_t delta) {
+    value.store(value.load(std::memory_order_relaxed) + delta,
+                std::memory_order_relaxed);
+  }
+  uint64_t Get() const { return value.load(std::memory_order_relaxed); }
+  void Reset() { value.store(0, std::memory_order_relaxed); }
+};
+
+struct OpCounters {
+  Counter calls, total_ns, flops, bytes;
+  Counter latency[S21_STATS_BUCKETS];
+  Counter elements[S21_STATS_BUCKETS];
+};
+
+struct ThreadCounters {
+  OpCounters ops[S21_STATS_OPS];
+};
+
+void AddTo(S21OpStats &to, const OpCounters &from) {
+  to.calls += from.calls.Get();
+  to.total_ns += from.total_ns.Get();
+  to.flops += from.flops.Get();
+  to.bytes += from.bytes.Get();
+  for (int i = 0; i < S21_STATS_BUCKETS; ++i) {
+    to.latency_ns_log2[i] += from.latency[i].Get();
+    to.elements_log2[i] += from.elements[i].Get();
+  }
+}
+
+// Реестр счетчиков живых потоков; итоги завершившихся потоков
+// складываются в retired, чтобы не терялись
+struct Registry {
+  std::mutex mutex;
+  std::vector<ThreadCounters *> threads;
+  S21StatsSnapshot retired;
+};
+
+Registry &GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+class ThreadHandle {
+ public:
+  ThreadHandle() {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.push_back(&counters_);
+  }
+  ~ThreadHandle() {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (int op = 0; op < S21_STATS_OPS; ++op) {
+      AddTo(registry.retired.ops[op], counters_.ops[op]);
+    }
+    registry.threads.erase(std::find(registry.threads.begin(),
+                                     registry.threads.end(), &counters_));
+  }
+  ThreadCounters &Counters() { return counters_; }
+
+ private:
+  ThreadCounters counters_;
+};
+
+thread_local S21Op current_op = S21Op::kCount;
+
+ThreadCounters &LocalCounters() {
+  thread_local ThreadHandle handle;
+  return handle.Counters();
+}
+
+int Log2Bucket(uint64_t value) {
+  int bucket = 0;
+  while (value > 1 && bucket < S21_STATS_BUCKETS - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+uint64_t Clamp(double value) {
+  if (!(value > 0)) return 0;
+  if (value >= 1.8e19) return UINT64_MAX;
+  return static_cast<uint64_t>(value);
+}
+
+const char *const kOpNames[S21_STATS_OPS] = {
+    "EqMatrix",         "SumMatrix",     "SubMatrix",       "MulNumber",
+    "MulMatrix",        "Transpose",     "CalcComplements", "Determinant",
+    "DeterminantExact", "InverseMatrix", "Solve",           "SolveRefined",
+    "Pow",              "Exp",           "Gemm",            "Axpy"};
+
+}  // namespace
+
+const char *S21OpName(S21Op op) {
+  return op == S21Op::kCount ? "Other" : kOpNames[static_cast<int>(op)];
+}
+
+S21Op S21StatsCurrentOp() { return current_op; }
+
+S21StatsSnapshot S21MatrixStatsSnapshot() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  S21StatsSnapshot snapshot = registry.retired;
+  for (const ThreadCounters *thread : registry.threads) {
+    for (int op = 0; op < S21_STATS_OPS; ++op) {
+      AddTo(snapshot.ops[op], thread->ops[op]);
+    }
+  }
+  return snapshot;
+}
+
+void S21MatrixStatsReset() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.retired = S21StatsSnapshot();
+  for (ThreadCounters *thread : registry.threads) {
+    for (OpCounters &op : thread->ops) {
+      op.calls.Reset();
+      op.total_ns.Reset();
+      op.flops.Reset();
+      op.bytes.Reset();
+      for (int i = 0; i < S21_STATS_BUCKETS; ++i) {
+        op.latency[i].Reset();
+        op.elements[i].Reset();
+      }
+    }
+  }
+}
+
+std::string S21MatrixStatsJson() {
+  S21StatsSnapshot snapshot = S21MatrixStatsSnapshot();
+  std::ostringstream out;
+  auto histogram = [&out](const uint64_t *buckets) {
+    int last = S21_STATS_BUCKETS - 1;
+    while (last > 0 && buckets[last] == 0) --last;
+    out << "[";
+    for (int i = 0; i <= last; ++i) out << (i ? "," : "") << buckets[i];
+    out << "]";
+  };
+
+  out << "{\"operations\":{";
+  bool first = true;
+  for (int op = 0; op < S21_STATS_OPS; ++op) {
+    const S21OpStats &stats = snapshot.ops[op];
+    if (stats.calls == 0) continue;
+    out << (first ? "" : ",") << "\"" << kOpNames[op] << "\":{"
+        << "\"calls\":" << stats.calls << ",\"total_ns\":" << stats.total_ns
+        << ",\"flops\":" << stats.flops << ",\"bytes\":" << stats.bytes
+        << ",\"latency_ns_log2\":";
+    histogram(stats.latency_ns_log2);
+    out << ",\"elements_log2\":";
+    histogram(stats.elements_log2);
+    out << "}";
+    first = false;
+  }
+  out << "}}";
+  return out.str();
+}
+
+S21StatsScope::S21StatsScope(S21Op op, int64_t elements, double flops,
+                             double bytes)
+    : op_(op),
+      active_(current_op == S21Op::kCount),
+      elements_(elements),
+      flops_(flops),
+      bytes_(bytes) {
+  if (active_) {
+    current_op = op;
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+S21StatsScope::~S21StatsScope() {
+  if (!active_) return;
+  uint64_t ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_)
+          .count());
+  OpCounters &counters = LocalCounters().ops[static_cast<int>(op_)];
+  counters.calls.Add(1);
+  counters.total_ns.Add(ns);
+  counters.flops.Add(Clamp(flops_));
+  counters.bytes.Add(Clamp(bytes_));
+  counters.latency[Log2Bucket(ns)].Add(1);
+  counters.elements[Log2Bucket(elements_ > 0 ? elements_ : 0)].Add(1);
+  current_op = S21Op::kCount;
+}
@@ -0,0 +1,89 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_STATS_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Счетчики операций S21Matrix: число вызовов, распределение размеров,
+// гистограмма задержек, оценка FLOP и перемещенных байт. Методы матрицы
+// пишут в них только при сборке с -DS21_MATRIX_STATS (make STATS=1),
+// иначе S21_STATS_SCOPE раскрывается в пустоту.
+
+enum class S21Op {
+  kEqMatrix,
+  kSumMatrix,
+  kSubMatrix,
+  kMulNumber,
+  kMulMatrix,
+  kTranspose,
+  kCalcComplements,
+  kDeterminant,
+  kDeterminantExact,
+  kInverseMatrix,
+  kSolve,
+  kSolveRefined,
+  kPow,
+  kExp,
+  kGemm,
+  kAxpy,
+  kCount
+};
+
+#define S21_STATS_OPS static_cast<int>(S21Op::kCount)
+#define S21_STATS_BUCKETS 32  // корзины по степеням двойки
+
+struct S21OpStats {
+  uint64_t calls = 0;
+  uint64_t total_ns = 0;
+  uint64_t flops = 0;
+  uint64_t bytes = 0;
+  uint64_t latency_ns_log2[S21_STATS_BUCKETS] = {};  // [k]: 2^k <= ns < 2^k+1
+  uint64_t elements_log2[S21_STATS_BUCKETS] = {};    // размер входа
+};
+
+struct S21StatsSnapshot {
+  S21OpStats ops[S21_STATS_OPS];
+  const S21OpStats &operator[](S21Op op) const {
+    return ops[static_cast<int>(op)];
+  }
+};
+
+const char *S21OpName(S21Op op);
+S21StatsSnapshot S21MatrixStatsSnapshot();  // сумма по всем потокам
+std::string S21MatrixStatsJson();
+void S21MatrixStatsReset();  // вызывать, пока операции не выполняются
+// операция, внутри которой сейчас находится поток, или S21Op::kCount
+S21Op S21StatsCurrentOp();
+
+// Замеряет время жизни и записывает вызов в счетчики текущего потока.
+// Вложенные замеры в том же потоке не пишутся: InverseMatrix, вызывающий
+// Determinant, считается одним вызовом InverseMatrix.
+class S21StatsScope {
+ public:
+  S21StatsScope(S21Op op, int64_t elements, double flops, double bytes);
+  ~S21StatsScope();
+  S21StatsScope(const S21StatsScope &) = delete;
+  S21StatsScope &operator=(const S21StatsScope &) = delete;
+
+ private:
+  S21Op op_;
+  bool active_;  // false для вложенного замера
+  int64_t elements_;
+  double flops_, bytes_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#ifdef S21_MATRIX_STATS
+#define S21_STATS_CONCAT_(a, b) a##b
+#define S21_STATS_CONCAT(a, b) S21_STATS_CONCAT_(a, b)
+#define S21_STATS_SCOPE(op, elements, flops, bytes)          \
+  S21StatsScope S21_STATS_CONCAT(s21_stats_scope_, __LINE__)( \
+      op, elements, flops, bytes)
+#else
+#define S21_STATS_SCOPE(op, elements, flops, bytes) \
+  do {                                              \
+  } while (0)
+#endif
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_MATRIX_STATS_H
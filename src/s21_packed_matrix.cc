@@ -0,0 +1,255 @@
+#include "s21_packed_matrix.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "s21_matrix_kernels.h"
+
+namespace {
+
+void CheckSize(int size) {
+  if (size <= 0) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+}
+
+void CheckSquare(const S21Matrix &m) {
+  if (m.GetRows() != m.GetCols()) {
+    throw std::invalid_argument("\nThe matrix must be square\n");
+  }
+}
+
+std::size_t PackedCount(int size) {
+  return static_cast<std::size_t>(size) * (size + 1) / 2;
+}
+
+// начало строки i нижнего треугольника
+std::size_t LowerStart(int row) {
+  return static_cast<std::size_t>(row) * (row + 1) / 2;
+}
+
+// начало строки i верхнего треугольника: перед ней n + (n - 1) + ... +
+// (n - i + 1) элементов
+std::size_t UpperStart(int size, int row) {
+  return static_cast<std::size_t>(row) * size -
+         static_cast<std::size_t>(row) * (row - 1) / 2;
+}
+
+}  // namespace
+
+S21SymmetricMatrix::S21SymmetricMatrix(int size) : size_(size) {
+  CheckSize(size);
+  packed_.assign(PackedCount(size), 0.0);
+}
+
+S21SymmetricMatrix S21SymmetricMatrix::FromDense(const S21Matrix &m) {
+  CheckSquare(m);
+  S21SymmetricMatrix result(m.GetRows());
+  double *p = result.packed_.data();
+  for (int i = 0; i < result.size_; ++i) {
+    for (int j = 0; j <= i; ++j) *p++ = m(i, j);
+  }
+  return result;
+}
+
+std::size_t S21SymmetricMatrix::Index(int row, int col) const {
+  if (row < 0 || col < 0 || row >= size_ || col >= size_) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  return row >= col ? LowerStart(row) + col : LowerStart(col) + row;
+}
+
+double &S21SymmetricMatrix::operator()(int row, int col) {
+  return packed_[Index(row, col)];
+}
+
+double S21SymmetricMatrix::operator()(int row, int col) const {
+  return packed_[Index(row, col)];
+}
+
+S21Matrix S21SymmetricMatrix::ToDense() const {
+  S21Matrix result(size_, size_);
+  const double *p = packed_.data();
+  for (int i = 0; i < size_; ++i) {
+    for (int j = 0; j <= i; ++j, ++p) result(i, j) = result(j, i) = *p;
+  }
+  return result;
+}
+
+// Строка i результата: a(i, j) для j <= i лежат подряд в строке i, для
+// j > i - в столбце i нижнего треугольника, то есть в строках ниже
+S21Matrix S21SymmetricMatrix::Multiply(const S21Matrix &b,
+                                       S21ExecutionPolicy policy) const {
+  int n = size_, m = b.GetCols();
+  S21CheckRows(n, b);
+  S21Matrix storage;
+  const S21Matrix &rows = S21Matrix::RowMajor(b, storage);
+  const double *b_data = rows.Data();
+  std::size_t b_stride = rows.Stride();
+  S21Matrix result(n, m);
+  double *c_data = result.Data();
+  std::size_t c_stride = result.Stride();
+  S21ForRows(n, 64, policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *c_row = c_data + i * c_stride;
+      const double *a_row = packed_.data() + LowerStart(i);
+      for (int k = 0; k < n; ++k) {
+        double a = k <= i ? a_row[k] : packed_[LowerStart(k) + i];
+        if (a == 0.0) continue;
+        const double *b_row = b_data + k * b_stride;
+        for (int j = 0; j < m; ++j) c_row[j] += a * b_row[j];
+      }
+    }
+  });
+  return result;
+}
+
+void S21SymmetricMatrix::RankKUpdate(double alpha, const S21Matrix &a,
+                                     double beta, S21ExecutionPolicy policy) {
+  S21CheckRows(size_, a);
+  S21Matrix storage;
+  const S21Matrix &rows = S21Matrix::RowMajor(a, storage);
+  const double *a_data = rows.Data();
+  std::size_t a_stride = rows.Stride();
+  int k = a.GetCols();
+  S21ForRows(size_, 64, policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *c_row = packed_.data() + LowerStart(i);
+      const double *a_i = a_data + i * a_stride;
+      for (int j = 0; j <= i; ++j) {
+        const double *a_j = a_data + j * a_stride;
+        double dot = 0.0;
+        for (int t = 0; t < k; ++t) dot += a_i[t] * a_j[t];
+        // при beta == 0 старое значение не читается, как в Gemm
+        c_row[j] = beta == 0.0 ? alpha * dot : alpha * dot + beta * c_row[j];
+      }
+    }
+  });
+}
+
+S21TriangularMatrix::S21TriangularMatrix(int size, S21Triangle triangle)
+    : size_(size), triangle_(triangle) {
+  CheckSize(size);
+  packed_.assign(PackedCount(size), 0.0);
+}
+
+S21TriangularMatrix S21TriangularMatrix::FromDense(const S21Matrix &m,
+                                                   S21Triangle triangle) {
+  CheckSquare(m);
+  S21TriangularMatrix result(m.GetRows(), triangle);
+  double *p = result.packed_.data();
+  for (int i = 0; i < result.size_; ++i) {
+    for (int j = 0; j < result.size_; ++j) {
+      if (result.Contains(i, j)) *p++ = m(i, j);
+    }
+  }
+  return result;
+}
+
+std::size_t S21TriangularMatrix::Index(int row, int col) const {
+  return triangle_ == S21Triangle::kLower
+             ? LowerStart(row) + col
+             : UpperStart(size_, row) + (col - row);
+}
+
+const double *S21TriangularMatrix::RowStart(int row) const {
+  return packed_.data() + (triangle_ == S21Triangle::kLower
+                               ? LowerStart(row)
+                               : UpperStart(size_, row));
+}
+
+double &S21TriangularMatrix::operator()(int row, int col) {
+  if (row < 0 || col < 0 || row >= size_ || col >= size_ ||
+      !Contains(row, col)) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  return packed_[Index(row, col)];
+}
+
+double S21TriangularMatrix::operator()(int row, int col) const {
+  if (row < 0 || col < 0 || row >= size_ || col >= size_) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  return Contains(row, col) ? packed_[Index(row, col)] : 0.0;
+}
+
+S21Matrix S21TriangularMatrix::ToDense() const {
+  S21Matrix result(size_, size_);
+  const double *p = packed_.data();
+  for (int i = 0; i < size_; ++i) {
+    for (int j = 0; j < size_; ++j) {
+      if (Contains(i, j)) result(i, j) = *p++;
+    }
+  }
+  return result;
+}
+
+S21Matrix S21TriangularMatrix::Multiply(const S21Matrix &b,
+                                        S21ExecutionPolicy policy) const {
+  int n = size_, m = b.GetCols();
+  S21CheckRows(n, b);
+  S21Matrix storage;
+  const S21Matrix &rows = S21Matrix::RowMajor(b, storage);
+  const double *b_data = rows.Data();
+  std::size_t b_stride = rows.Stride();
+  S21Matrix result(n, m);
+  double *c_data = result.Data();
+  std::size_t c_stride = result.Stride();
+  bool lower = triangle_ == S21Triangle::kLower;
+  S21ForRows(n, 64, policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *c_row = c_data + i * c_stride;
+      const double *t_row = RowStart(i);
+      int first = lower ? 0 : i, last = lower ? i : n - 1;
+      for (int k = first; k <= last; ++k) {
+        double t = t_row[k - first];
+        if (t == 0.0) continue;
+        const double *b_row = b_data + k * b_stride;
+        for (int j = 0; j < m; ++j) c_row[j] += t * b_row[j];
+      }
+    }
+  });
+  return result;
+}
+
+// Строки упакованной матрицы читаются только подряд. Без транспонирования
+// x[i] = (b[i] - sum t(i, k) x[k]) / t(i, i); с транспонированием строка i
+// матрицы - это столбец i системы, поэтому после x[i] /= t(i, i) она сразу
+// вычитается из оставшихся строк правой части
+S21Matrix S21TriangularMatrix::Solve(const S21Matrix &b,
+                                     bool transpose) const {
+  int n = size_, m = b.GetCols();
+  S21CheckRows(n, b);
+  S21Matrix x = b.InLayout(S21Layout::kRowMajor);
+  double *data = x.Data();
+  std::size_t stride = x.Stride();
+  bool lower = triangle_ == S21Triangle::kLower;
+  bool forward = lower != transpose;
+  for (int step = 0; step < n; ++step) {
+    int i = forward ? step : n - 1 - step;
+    const double *t_row = RowStart(i);
+    int first = lower ? 0 : i, last = lower ? i : n - 1;
+    double pivot = t_row[i - first];
+    // как в ленточном LU: только точный ноль, без абсолютного порога
+    if (pivot == 0.0 || !std::isfinite(pivot)) {
+      throw std::logic_error("\nDeterminant value can't be equal to 0\n");
+    }
+    double *x_i = data + i * stride;
+    if (!transpose) {
+      for (int k = first; k <= last; ++k) {
+        if (k == i || t_row[k - first] == 0.0) continue;
+        const double *x_k = data + k * stride;
+        for (int j = 0; j < m; ++j) x_i[j] -= t_row[k - first] * x_k[j];
+      }
+    }
+    for (int j = 0; j < m; ++j) x_i[j] /= pivot;
+    if (transpose) {
+      for (int k = first; k <= last; ++k) {
+        if (k == i || t_row[k - first] == 0.0) continue;
+        double *x_k = data + k * stride;
+        for (int j = 0; j < m; ++j) x_k[j] -= t_row[k - first] * x_i[j];
+      }
+    }
+  }
+  return x;
+}
@@ -0,0 +1,80 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_PACKED_MATRIX_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_PACKED_MATRIX_H
+
+#include <cstddef>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+enum class S21Triangle { kLower, kUpper };
+
+// Симметричная матрица n x n в упакованном виде: хранится только нижний
+// треугольник по строкам, n (n + 1) / 2 элементов вместо n^2.
+// (i, j) и (j, i) - один и тот же элемент
+class S21SymmetricMatrix {
+ public:
+  explicit S21SymmetricMatrix(int size);
+  // берется нижний треугольник m, симметричность не проверяется
+  static S21SymmetricMatrix FromDense(const S21Matrix &m);
+
+  int GetSize() const { return size_; }
+  const std::vector<double> &Packed() const { return packed_; }
+  double &operator()(int row, int col);
+  double operator()(int row, int col) const;
+
+  S21Matrix ToDense() const;
+  // A * B (SYMM); строки результата независимы и при kPar считаются
+  // параллельно
+  S21Matrix Multiply(
+      const S21Matrix &b,
+      S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  // this = alpha * A * A^T + beta * this (SYRK) для A размера n x k,
+  // считается только хранимый треугольник
+  void RankKUpdate(double alpha, const S21Matrix &a, double beta = 1.0,
+                   S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq);
+
+ private:
+  int size_;
+  std::vector<double> packed_;
+
+  std::size_t Index(int row, int col) const;
+};
+
+// Треугольная матрица n x n в упакованном виде: строки треугольника
+// подряд, n (n + 1) / 2 элементов. Вне треугольника - нули
+class S21TriangularMatrix {
+ public:
+  S21TriangularMatrix(int size, S21Triangle triangle);
+  // второй треугольник m отбрасывается
+  static S21TriangularMatrix FromDense(const S21Matrix &m,
+                                       S21Triangle triangle);
+
+  int GetSize() const { return size_; }
+  S21Triangle GetTriangle() const { return triangle_; }
+  const std::vector<double> &Packed() const { return packed_; }
+  // запись только внутри треугольника, чтение вне него дает 0
+  double &operator()(int row, int col);
+  double operator()(int row, int col) const;
+
+  S21Matrix ToDense() const;
+  // T * B (TRMM) за n^2 m / 2 умножений
+  S21Matrix Multiply(
+      const S21Matrix &b,
+      S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+  // T X = B или T^T X = B подстановкой (TRSM)
+  S21Matrix Solve(const S21Matrix &b, bool transpose = false) const;
+
+ private:
+  int size_;
+  S21Triangle triangle_;
+  std::vector<double> packed_;
+
+  bool Contains(int row, int col) const {
+    return triangle_ == S21Triangle::kLower ? col <= row : col >= row;
+  }
+  std::size_t Index(int row, int col) const;
+  // первый хранимый элемент строки: (i, 0) для нижнего, (i, i) для верхнего
+  const double *RowStart(int row) const;
+};
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_PACKED_MATRIX_H
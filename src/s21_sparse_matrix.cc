@@ -0,0 +1,120 @@
+#include "s21_sparse_matrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "s21_matrix_kernels.h"
+
+S21SparseMatrix::S21SparseMatrix(int rows, int cols)
+    : rows_(rows), cols_(cols) {
+  if (rows < 0 || cols < 0) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  // выделение после проверки; + 1 в size_t не переполняется при INT_MAX
+  row_starts_.assign(static_cast<std::size_t>(rows) + 1, 0);
+}
+
+// Тройки сортируются по (строка, столбец), соседние повторы складываются
+S21SparseMatrix S21SparseMatrix::FromTriplets(
+    int rows, int cols, std::vector<S21Triplet> triplets) {
+  S21SparseMatrix result(rows, cols);
+  for (const S21Triplet &t : triplets) {
+    if (t.row < 0 || t.row >= rows || t.col < 0 || t.col >= cols) {
+      throw std::invalid_argument("\nIndex out of range\n");
+    }
+  }
+  std::sort(triplets.begin(), triplets.end(),
+            [](const S21Triplet &a, const S21Triplet &b) {
+              return a.row != b.row ? a.row < b.row : a.col < b.col;
+            });
+  result.columns_.reserve(triplets.size());
+  result.values_.reserve(triplets.size());
+  for (std::size_t i = 0; i < triplets.size();) {
+    const S21Triplet &first = triplets[i];
+    double value = 0.0;
+    for (; i < triplets.size() && triplets[i].row == first.row &&
+           triplets[i].col == first.col;
+         ++i) {
+      value += triplets[i].value;
+    }
+    if (value == 0.0) continue;
+    result.columns_.push_back(first.col);
+    result.values_.push_back(value);
+    ++result.row_starts_[first.row + 1];
+  }
+  for (int i = 0; i < rows; ++i) {
+    result.row_starts_[i + 1] += result.row_starts_[i];
+  }
+  return result;
+}
+
+S21SparseMatrix S21SparseMatrix::FromDense(const S21Matrix &m,
+                                           double tolerance) {
+  S21SparseMatrix result(m.GetRows(), m.GetCols());
+  for (int i = 0; i < m.GetRows(); ++i) {
+    for (int j = 0; j < m.GetCols(); ++j) {
+      double value = m(i, j);
+      if (std::fabs(value) <= tolerance) continue;
+      result.columns_.push_back(j);
+      result.values_.push_back(value);
+    }
+    result.row_starts_[i + 1] = static_cast<int>(result.values_.size());
+  }
+  return result;
+}
+
+double S21SparseMatrix::GetDensity() const {
+  if (rows_ == 0 || cols_ == 0) return 0.0;
+  return static_cast<double>(values_.size()) / rows_ / cols_;
+}
+
+double S21SparseMatrix::operator()(int row, int col) const {
+  if (row < 0 || row >= rows_ || col < 0 || col >= cols_) {
+    throw std::invalid_argument("\nIndex out of range\n");
+  }
+  auto begin = columns_.begin() + row_starts_[row];
+  auto end = columns_.begin() + row_starts_[row + 1];
+  auto it = std::lower_bound(begin, end, col);
+  if (it == end || *it != col) return 0.0;
+  return values_[it - columns_.begin()];
+}
+
+S21Matrix S21SparseMatrix::ToDense() const {
+  S21Matrix result(rows_, cols_);
+  for (int i = 0; i < rows_; ++i) {
+    for (int k = row_starts_[i]; k < row_starts_[i + 1]; ++k) {
+      result(i, columns_[k]) = values_[k];
+    }
+  }
+  return result;
+}
+
+// Строка результата - сумма строк dense с весами из строки this,
+// поэтому внутренний цикл идет по строке подряд
+S21Matrix S21SparseMatrix::Multiply(const S21Matrix &dense,
+                                    S21ExecutionPolicy policy) const {
+  if (cols_ != dense.GetRows()) {
+    throw std::invalid_argument("\nWrong count of rows or columns\n");
+  }
+  int n = dense.GetCols();
+  S21Matrix storage;  // копия нужна только для kColMajor
+  const S21Matrix &b = S21Matrix::RowMajor(dense, storage);
+  S21Matrix result(rows_, n);
+  if (rows_ == 0 || n == 0) return result;
+  const double *b_data = b.Data();
+  double *c_data = result.Data();
+  int b_stride = b.Stride(), c_stride = result.Stride();
+  S21ForRows(rows_, 64, policy, [&](int r0, int r1) {
+    for (int i = r0; i < r1; ++i) {
+      double *c_row = c_data + static_cast<std::size_t>(i) * c_stride;
+      for (int k = row_starts_[i]; k < row_starts_[i + 1]; ++k) {
+        const double *b_row =
+            b_data + static_cast<std::size_t>(columns_[k]) * b_stride;
+        double value = values_[k];
+        for (int j = 0; j < n; ++j) c_row[j] += value * b_row[j];
+      }
+    }
+  });
+  return result;
+}
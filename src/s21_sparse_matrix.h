@@ -0,0 +1,53 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_SPARSE_MATRIX_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_SPARSE_MATRIX_H
+
+#include <cstddef>
+#include <vector>
+
+#include "s21_matrix_oop.h"
+
+struct S21Triplet {
+  int row;
+  int col;
+  double value;
+};
+
+// Разреженная матрица в формате CSR: ненулевые элементы строки i лежат в
+// columns и values на позициях [row_starts[i], row_starts[i + 1]),
+// столбцы внутри строки упорядочены
+class S21SparseMatrix {
+ public:
+  S21SparseMatrix() = default;
+  S21SparseMatrix(int rows, int cols);  // нулевая матрица
+  // повторяющиеся позиции складываются, явные нули отбрасываются
+  static S21SparseMatrix FromTriplets(int rows, int cols,
+                                      std::vector<S21Triplet> triplets);
+  // элементы с модулем не больше tolerance считаются нулями
+  static S21SparseMatrix FromDense(const S21Matrix &m, double tolerance = 0.0);
+
+  int GetRows() const { return rows_; }
+  int GetCols() const { return cols_; }
+  std::size_t GetNonZeros() const { return values_.size(); }
+  double GetDensity() const;
+
+  double operator()(int row, int col) const;  // двоичный поиск в строке
+  S21Matrix ToDense() const;
+  // произведение на плотную матрицу, строки результата считаются
+  // параллельно при политике kPar
+  S21Matrix Multiply(
+      const S21Matrix &dense,
+      S21ExecutionPolicy policy = S21ExecutionPolicy::kSeq) const;
+
+  const std::vector<int> &RowStarts() const { return row_starts_; }
+  const std::vector<int> &Columns() const { return columns_; }
+  const std::vector<double> &Values() const { return values_; }
+
+ private:
+  int rows_ = 0;
+  int cols_ = 0;
+  std::vector<int> row_starts_ = {0};
+  std::vector<int> columns_;
+  std::vector<double> values_;
+};
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_SPARSE_MATRIX_H
@@ -0,0 +1,250 @@
+#include "s21_thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+thread_local const std::atomic<bool> *current_cancel = nullptr;
+// Пул и номер рабочего, которым является текущий поток
+thread_local const S21ThreadPool *current_pool = nullptr;
+thread_local int current_worker = -1;
+
+std::atomic<int> default_threads{0};
+std::atomic<bool> default_created{false};
+
+}  // namespace
+
+S21CancelToken::S21CancelToken()
+    : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+void S21CancelToken::Cancel() { flag_->store(true); }
+
+bool S21CancelToken::IsCancelled() const { return flag_->load(); }
+
+S21CancelScope::S21CancelScope(const S21CancelToken &token)
+    : previous_(current_cancel) {
+  current_cancel = token.flag_.get();
+}
+
+S21CancelScope::~S21CancelScope() { current_cancel = previous_; }
+
+void S21CheckCancelled() {
+  if (current_cancel && current_cancel->load(std::memory_order_relaxed)) {
+    throw S21Cancelled();
+  }
+}
+
+S21ThreadPool::S21ThreadPool(int threads) : pending_(0), stop_(false) {
+  if (threads <= 0) {
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+  }
+  for (int i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (int i = 0; i < threads; ++i) {
+    workers_.emplace_back(&S21ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+S21ThreadPool::~S21ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  ready_.notify_all();
+  for (std::thread &worker : workers_) worker.join();
+}
+
+// счетчик меняется под mutex_, чтобы спящий поток не пропустил сигнал
+void S21ThreadPool::Submit(std::function<void()> task) {
+  int self = CurrentWorker();
+  if (self >= 0) {
+    Queue &queue = *queues_[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (self < 0) injected_.push_back(std::move(task));
+    ++pending_;
+  }
+  ready_.notify_one();
+}
+
+int S21ThreadPool::GetThreadCount() const {
+  return static_cast<int>(workers_.size());
+}
+
+bool S21ThreadPool::RunPendingTask() {
+  std::function<void()> task;
+  if (!TakeTask(CurrentWorker(), task)) return false;
+  task();
+  return true;
+}
+
+bool S21ThreadPool::IsWorkerThread() const { return CurrentWorker() >= 0; }
+
+S21ThreadPool &S21ThreadPool::Default() {
+  static S21ThreadPool pool(default_threads.load());
+  default_created.store(true);
+  return pool;
+}
+
+void S21ThreadPool::ConfigureDefault(int threads) {
+  if (default_created.load()) {
+    throw std::logic_error("\nThe default pool is already running\n");
+  }
+  default_threads.store(threads);
+}
+
+int S21ThreadPool::CurrentWorker() const {
+  return current_pool == this ? current_worker : -1;
+}
+
+// своя очередь с хвоста (свежие задачи горячие в кэше), затем общая,
+// затем чужие с головы (там самые крупные куски рекурсивной работы)
+bool S21ThreadPool::TakeTask(int self, std::function<void()> &task) {
+  if (pending_.load() == 0) return false;
+  if (self >= 0) {
+    Queue &queue = *queues_[self];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      --pending_;
+      return true;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!injected_.empty()) {
+      task = std::move(injected_.front());
+      injected_.pop_front();
+      --pending_;
+      return true;
+    }
+  }
+  int count = static_cast<int>(queues_.size());
+  for (int k = 1; k <= count; ++k) {
+    int victim = (self + k + count) % count;
+    if (victim == self) continue;
+    Queue &queue = *queues_[victim];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      --pending_;
+      return true;
+    }
+  }
+  return false;
+}
+
+// оставшиеся задачи выполняются до остановки, чтобы future не зависли
+void S21ThreadPool::WorkerLoop(int index) {
+  current_pool = this;
+  current_worker = index;
+  for (;;) {
+    std::function<void()> task;
+    if (TakeTask(index, task)) {
+      task();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_.wait(lock, [this] { return stop_ || pending_.load() > 0; });
+    if (stop_ && pending_.load() == 0) return;
+  }
+}
+
+S21TaskGroup::S21TaskGroup(S21ThreadPool &pool) : pool_(pool), pending_(0) {}
+
+S21TaskGroup::~S21TaskGroup() {
+  try {
+    Wait();
+  } catch (...) {
+  }
+}
+
+// Задача лежит и в пуле, и в очереди группы; обертка в пуле держит ее
+// через shared_ptr и не трогает группу, если задачу уже взял Wait
+void S21TaskGroup::Run(std::function<void()> task) {
+  auto item = std::make_shared<Task>();
+  item->body = std::move(task);
+  item->cancel = current_cancel;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++pending_;
+    queued_.push_back(item);
+  }
+  pool_.Submit([this, item] {
+    if (!item->claimed.exchange(true)) Execute(*item);
+  });
+}
+
+// сигнал подается под mutex_: Wait не вернется и не разрушит группу,
+// пока задача его не отпустит
+void S21TaskGroup::Execute(Task &task) {
+  const std::atomic<bool> *previous = current_cancel;
+  current_cancel = task.cancel;
+  std::exception_ptr error;
+  try {
+    task.body();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  current_cancel = previous;
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (error && !error_) error_ = error;
+  if (--pending_ == 0) done_.notify_all();
+}
+
+void S21TaskGroup::Wait() {
+  bool worker = pool_.IsWorkerThread();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (pending_ > 0) {
+    if (!queued_.empty()) {
+      // с хвоста, как из своей очереди рабочего: свежие задачи в кэше
+      std::shared_ptr<Task> task = std::move(queued_.back());
+      queued_.pop_back();
+      if (task->claimed.exchange(true)) continue;
+      lock.unlock();
+      Execute(*task);
+      lock.lock();
+      continue;
+    }
+    if (worker) {
+      lock.unlock();
+      bool ran = pool_.RunPendingTask();
+      lock.lock();
+      if (ran) continue;
+    }
+    done_.wait(lock, [this] { return pending_ == 0 || !queued_.empty(); });
+  }
+  std::exception_ptr error;
+  std::swap(error, error_);
+  lock.unlock();
+  if (error) std::rethrow_exception(error);
+}
+
+// кусков в несколько раз больше потоков, чтобы выровнять нагрузку
+void S21ParallelFor(int begin, int end, int grain,
+                    const std::function<void(int, int)> &body) {
+  int count = end - begin;
+  if (count <= 0) return;
+  if (grain < 1) grain = 1;
+  int chunks = std::min(count / grain,
+                        4 * S21ThreadPool::Default().GetThreadCount());
+  if (chunks <= 1) {
+    body(begin, end);
+    return;
+  }
+  S21TaskGroup group;
+  for (int c = 0; c < chunks; ++c) {
+    int lo = begin + static_cast<int>(int64_t(count) * c / chunks);
+    int hi = begin + static_cast<int>(int64_t(count) * (c + 1) / chunks);
+    group.Run([&body, lo, hi] { body(lo, hi); });
+  }
+  group.Wait();
+}
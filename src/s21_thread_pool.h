@@ -0,0 +1,134 @@
+#ifndef CPP1_S21_MATRIXPLUS_SRC_S21_THREAD_POOL_H
+#define CPP1_S21_MATRIXPLUS_SRC_S21_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Исключение, которым прерывается отмененная операция
+class S21Cancelled : public std::runtime_error {
+ public:
+  S21Cancelled() : std::runtime_error("\nOperation was cancelled\n") {}
+};
+
+// Флаг отмены, общий для всех копий токена
+class S21CancelToken {
+ public:
+  S21CancelToken();
+  void Cancel();
+  bool IsCancelled() const;
+
+ private:
+  friend class S21CancelScope;
+  std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+// Делает токен текущим для потока: длинные циклы библиотеки вызывают
+// S21CheckCancelled и бросают S21Cancelled, если токен отменен
+class S21CancelScope {
+ public:
+  explicit S21CancelScope(const S21CancelToken &token);
+  ~S21CancelScope();
+  S21CancelScope(const S21CancelScope &) = delete;
+  S21CancelScope &operator=(const S21CancelScope &) = delete;
+
+ private:
+  const std::atomic<bool> *previous_;
+};
+
+void S21CheckCancelled();
+
+// Пул рабочих потоков с перехватом задач (work stealing): у каждого
+// рабочего своя очередь, задачи из рабочего потока кладутся в нее и
+// берутся с хвоста, свободные потоки забирают задачи у соседей с головы.
+// Задачи из сторонних потоков попадают в общую очередь.
+class S21ThreadPool {
+ public:
+  explicit S21ThreadPool(int threads = 0);  // 0 - по числу ядер
+  ~S21ThreadPool();
+  S21ThreadPool(const S21ThreadPool &) = delete;
+  S21ThreadPool &operator=(const S21ThreadPool &) = delete;
+
+  void Submit(std::function<void()> task);
+  int GetThreadCount() const;
+  // Выполняет одну ожидающую задачу в вызывающем потоке, если она есть.
+  // Так ожидающий поток помогает пулу вместо того, чтобы блокироваться
+  bool RunPendingTask();
+  bool IsWorkerThread() const;  // вызывающий поток - рабочий этого пула
+
+  static S21ThreadPool &Default();
+  // Число потоков пула по умолчанию; вызывать до первого Default()
+  static void ConfigureDefault(int threads);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> injected_;
+  std::atomic<int> pending_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  bool stop_;
+
+  int CurrentWorker() const;
+  bool TakeTask(int self, std::function<void()> &task);
+  void WorkerLoop(int index);
+};
+
+// Группа задач fork/join. Wait сам выполняет еще не взятые задачи группы,
+// поэтому вложенные группы не блокируют рабочие потоки и не плодят новых.
+// Сторонний поток берет только задачи своей группы и, когда их не
+// осталось, спит до завершения остальных; рабочий поток пула помогает
+// и с чужими задачами. Задачи наследуют токен отмены потока, вызвавшего Run
+class S21TaskGroup {
+ public:
+  explicit S21TaskGroup(S21ThreadPool &pool = S21ThreadPool::Default());
+  ~S21TaskGroup();
+  S21TaskGroup(const S21TaskGroup &) = delete;
+  S21TaskGroup &operator=(const S21TaskGroup &) = delete;
+
+  void Run(std::function<void()> task);
+  // Дожидается всех задач и перебрасывает первое исключение из них
+  void Wait();
+
+ private:
+  // задачу выполняет тот, кто первым ее захватит: пул или Wait
+  struct Task {
+    std::function<void()> body;
+    const std::atomic<bool> *cancel;
+    std::atomic<bool> claimed{false};
+  };
+
+  S21ThreadPool &pool_;
+  std::mutex mutex_;
+  std::condition_variable done_;
+  int pending_;
+  std::deque<std::shared_ptr<Task>> queued_;  // в том числе уже взятые
+  std::exception_ptr error_;
+
+  void Execute(Task &task);
+};
+
+// Политика выполнения поэлементных операций, по аналогии с
+// std::execution: seq - в вызывающем потоке, par - блоками строк в пуле,
+// par_unseq - как par, но внутри блока без ранних выходов, чтобы циклы
+// векторизовались
+enum class S21ExecutionPolicy { kSeq, kPar, kParUnseq };
+
+// Делит [begin, end) на куски не меньше grain и выполняет body(lo, hi)
+// группой задач пула по умолчанию
+void S21ParallelFor(int begin, int end, int grain,
+                    const std::function<void(int, int)> &body);
+
+#endif  // CPP1_S21_MATRIXPLUS_SRC_S21_THREAD_POOL_H
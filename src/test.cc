@@ -1,6 +1,26 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <variant>
+
+#include "s21_banded_matrix.h"
+#include "s21_matrix_alloc.h"
+#include "s21_matrix_blas.h"
+#include "s21_matrix_chain.h"
+#include "s21_matrix_inverse.h"
+#include "s21_matrix_mapped.h"
+#include "s21_matrix_market.h"
+#include "s21_matrix_npy.h"
 #include "s21_matrix_oop.h"
+#include "s21_matrix_pool.h"
+#include "s21_matrix_stats.h"
+#include "s21_packed_matrix.h"
 
 TEST(EqMatrix, eq) {
   int size = 5;
@@ -1483,6 +1503,1741 @@ TEST(InverseMatrix, 8dMatrix) {
   ASSERT_EQ(result.EqMatrix(expected), 1);
 }
 
+TEST(Solve, System) {
+  S21Matrix a(3, 3), b(3, 1), expected(3, 1);
+  a(0, 0) = 2;
+  a(0, 1) = 1;
+  a(0, 2) = -1;
+  a(1, 0) = -3;
+  a(1, 1) = -1;
+  a(1, 2) = 2;
+  a(2, 0) = -2;
+  a(2, 1) = 1;
+  a(2, 2) = 2;
+  b(0, 0) = 8;
+  b(1, 0) = -11;
+  b(2, 0) = -3;
+  expected(0, 0) = 2;
+  expected(1, 0) = 3;
+  expected(2, 0) = -1;
+  ASSERT_EQ(a.Solve(b).EqMatrix(expected), 1);
+}
+
+TEST(Solve, Singular) {
+  S21Matrix a(2, 2), b(2, 1);
+  a(0, 0) = 1;
+  a(0, 1) = 2;
+  a(1, 0) = 2;
+  a(1, 1) = 4;
+  EXPECT_ANY_THROW(a.Solve(b));
+}
+
+TEST(Solve, ScaledIdentity) {
+  // все ведущие элементы меньше EPS, но система хорошо обусловлена
+  S21Matrix a(4, 4), b(4, 1);
+  for (int i = 0; i < 4; ++i) {
+    a(i, i) = 1e-8;
+    b(i, 0) = (i + 1) * 1e-8;
+  }
+  S21Matrix x = a.Solve(b);
+  for (int i = 0; i < 4; ++i) EXPECT_NEAR(x(i, 0), i + 1, 1e-9);
+
+  S21Matrix inverse = a.Pow(-1);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(inverse(i, j) * 1e-8, i == j ? 1.0 : 0.0, 1e-12);
+    }
+  }
+  EXPECT_NO_THROW(S21MatrixInverse{a});
+}
+
+TEST(Pow, Positive) {
+  S21Matrix a(2, 2), expected(2, 2);
+  a(0, 0) = 1;
+  a(0, 1) = 1;
+  a(1, 0) = 1;
+  a(1, 1) = 0;
+  // степени матрицы Фибоначчи
+  expected(0, 0) = 89;
+  expected(0, 1) = 55;
+  expected(1, 0) = 55;
+  expected(1, 1) = 34;
+  ASSERT_EQ(a.Pow(10).EqMatrix(expected), 1);
+  ASSERT_EQ(a.Pow(1).EqMatrix(a), 1);
+}
+
+TEST(Pow, ZeroAndNegative) {
+  S21Matrix a(2, 2), identity(2, 2);
+  a(0, 0) = 4;
+  a(0, 1) = 7;
+  a(1, 0) = 2;
+  a(1, 1) = 6;
+  identity(0, 0) = identity(1, 1) = 1;
+  ASSERT_EQ(a.Pow(0).EqMatrix(identity), 1);
+  ASSERT_EQ(a.Pow(-3).EqMatrix(a.InverseMatrix().Pow(3)), 1);
+  ASSERT_EQ((a.Pow(3) * a.Pow(-3)).EqMatrix(identity), 1);
+}
+
+TEST(Pow, NotSquare) {
+  S21Matrix a(2, 3);
+  EXPECT_ANY_THROW(a.Pow(2));
+}
+
+TEST(Exp, Diagonal) {
+  S21Matrix a(2, 2), expected(2, 2);
+  a(0, 0) = 1;
+  a(1, 1) = -2;
+  expected(0, 0) = std::exp(1.0);
+  expected(1, 1) = std::exp(-2.0);
+  ASSERT_EQ(a.Exp().EqMatrix(expected), 1);
+}
+
+TEST(Exp, Rotation) {
+  S21Matrix a(2, 2), expected(2, 2);
+  double t = 10.0;
+  a(0, 1) = -t;
+  a(1, 0) = t;
+  expected(0, 0) = expected(1, 1) = std::cos(t);
+  expected(0, 1) = -std::sin(t);
+  expected(1, 0) = std::sin(t);
+  ASSERT_EQ(a.Exp().EqMatrix(expected), 1);
+}
+
+S21Matrix MakeInvertible(int size) {
+  S21Matrix a(size, size);
+  for (int i = 0; i < size; i++) {
+    for (int j = 0; j < size; j++) {
+      a(i, j) = (i == j) ? size + 1.0 : 1.0 / (i + j + 1.0);
+    }
+  }
+  return a;
+}
+
+TEST(MatrixInverse, Rank1) {
+  S21Matrix a = MakeInvertible(4), u(4, 1), v(4, 1);
+  S21MatrixInverse cached(a);
+  for (int i = 0; i < 4; i++) {
+    u(i, 0) = i + 1;
+    v(i, 0) = 0.5 - i;
+  }
+  cached.UpdateRank1(u, v);
+  S21Matrix updated = a + u * v.Transpose();
+  ASSERT_EQ(cached.Matrix().EqMatrix(updated), 1);
+  ASSERT_EQ(cached.Inverse().EqMatrix(updated.InverseMatrix()), 1);
+  ASSERT_EQ(cached.GetUpdateCount(), 1);
+}
+
+TEST(MatrixInverse, RankK) {
+  S21Matrix a = MakeInvertible(5), u(5, 2), v(5, 2);
+  S21MatrixInverse cached(a);
+  for (int i = 0; i < 5; i++) {
+    u(i, 0) = i;
+    u(i, 1) = 1.0 / (i + 1);
+    v(i, 0) = 0.25 * i;
+    v(i, 1) = -1.0;
+  }
+  cached.UpdateRankK(u, v);
+  S21Matrix updated = a + u * v.Transpose();
+  ASSERT_EQ(cached.Inverse().EqMatrix(updated.InverseMatrix()), 1);
+}
+
+TEST(MatrixInverse, RowAndColumn) {
+  S21Matrix a = MakeInvertible(4), row(1, 4), col(4, 1);
+  S21MatrixInverse cached(a);
+  for (int i = 0; i < 4; i++) {
+    row(0, i) = a(2, i) = i * i + 1;
+    col(i, 0) = a(i, 1) = 2.0 - i;
+  }
+  cached.UpdateRow(2, row);
+  cached.UpdateColumn(1, col);
+  ASSERT_EQ(cached.Matrix().EqMatrix(a), 1);
+  ASSERT_EQ(cached.Inverse().EqMatrix(a.InverseMatrix()), 1);
+}
+
+TEST(MatrixInverse, Refactor) {
+  S21Matrix a = MakeInvertible(3), u(3, 1), v(3, 1);
+  S21MatrixInverse cached(a, 2);
+  u(0, 0) = v(1, 0) = 0.1;
+  cached.UpdateRank1(u, v);
+  ASSERT_EQ(cached.GetUpdateCount(), 1);
+  cached.UpdateRank1(u, v);
+  ASSERT_EQ(cached.GetUpdateCount(), 0);
+  S21Matrix updated = cached.Matrix();
+  ASSERT_EQ(cached.Inverse().EqMatrix(updated.InverseMatrix()), 1);
+}
+
+TEST(MatrixInverse, SingularUpdate) {
+  S21Matrix a(2, 2), row(1, 2);
+  a(0, 0) = a(1, 1) = 1;
+  row(0, 1) = 0;
+  S21MatrixInverse cached(a);
+  EXPECT_ANY_THROW(cached.UpdateRow(0, row));
+  ASSERT_EQ(cached.Matrix().EqMatrix(a), 1);
+  EXPECT_ANY_THROW(S21MatrixInverse(a, 0));
+}
+
+TEST(Cache, DeterminantAndInverse) {
+  S21Matrix a = MakeInvertible(4);
+  a.EnableCache(true);
+  ASSERT_TRUE(a.IsCacheEnabled());
+  double det = a.Determinant();
+  S21Matrix inverse = a.InverseMatrix();
+  ASSERT_DOUBLE_EQ(a.Determinant(), det);
+  ASSERT_EQ(a.InverseMatrix().EqMatrix(inverse), 1);
+
+  const S21Matrix &view = a;
+  ASSERT_DOUBLE_EQ(view(1, 1), 5.0);
+  a(1, 1) = 10.0;
+  S21Matrix fresh(a);
+  ASSERT_DOUBLE_EQ(a.Determinant(), fresh.Determinant());
+  ASSERT_EQ(a.InverseMatrix().EqMatrix(fresh.InverseMatrix()), 1);
+}
+
+TEST(Cache, InvalidatedByMutators) {
+  S21Matrix a = MakeInvertible(3), b = MakeInvertible(3);
+  a.EnableCache(true);
+  a.Determinant();
+  a.SumMatrix(b);
+  S21Matrix sum = MakeInvertible(3) + b;
+  ASSERT_DOUBLE_EQ(a.Determinant(), sum.Determinant());
+  a.MulNumber(2);
+  sum.MulNumber(2);
+  ASSERT_DOUBLE_EQ(a.Determinant(), sum.Determinant());
+  a.SetRows(4);
+  a.SetColumns(4);
+  ASSERT_DOUBLE_EQ(a.Determinant(), 0.0);
+  ASSERT_TRUE(a.IsCacheEnabled());
+}
+
+TEST(Cache, Solve) {
+  S21Matrix a = MakeInvertible(5), b(5, 2);
+  for (int i = 0; i < 5; i++) b(i, 0) = b(i, 1) = i;
+  S21Matrix expected = a.Solve(b);
+  a.EnableCache(true);
+  ASSERT_EQ(a.Solve(b).EqMatrix(expected), 1);
+  ASSERT_EQ(a.Solve(b).EqMatrix(expected), 1);
+  a.MulNumber(0.5);
+  expected.MulNumber(2);
+  ASSERT_EQ(a.Solve(b).EqMatrix(expected), 1);
+  a.EnableCache(false);
+  ASSERT_FALSE(a.IsCacheEnabled());
+}
+
+TEST(SolveRefined, Converges) {
+  S21Matrix a = MakeInvertible(30), b(30, 2);
+  for (int i = 0; i < 30; i++) {
+    b(i, 0) = i;
+    b(i, 1) = 1.0 / (i + 1);
+  }
+  S21RefineStats stats;
+  S21Matrix x = a.SolveRefined(b, &stats);
+  ASSERT_TRUE(stats.converged);
+  ASSERT_FALSE(stats.fallback);
+  ASSERT_GT(stats.iterations, 0);
+  ASSERT_LT(stats.residual, 1e-12);
+  ASSERT_EQ(x.EqMatrix(a.Solve(b)), 1);
+}
+
+TEST(SolveRefined, FallbackToDouble) {
+  // 1e40 не помещается во float
+  S21Matrix a(2, 2), b(2, 1), expected(2, 1);
+  a(0, 0) = 1e40;
+  a(1, 1) = 2;
+  b(0, 0) = 3e40;
+  b(1, 0) = 4;
+  expected(0, 0) = 3;
+  expected(1, 0) = 2;
+  S21RefineStats stats;
+  ASSERT_EQ(a.SolveRefined(b, &stats).EqMatrix(expected), 1);
+  ASSERT_TRUE(stats.fallback);
+  ASSERT_FALSE(stats.converged);
+}
+
+TEST(SolveRefined, Singular) {
+  S21Matrix a(2, 2), b(2, 1);
+  a(0, 0) = a(0, 1) = a(1, 0) = a(1, 1) = 1;
+  EXPECT_ANY_THROW(a.SolveRefined(b));
+  EXPECT_ANY_THROW(a.SolveRefined(S21Matrix(3, 1)));
+}
+
+TEST(BigInt, Arithmetic) {
+  S21BigInt a = S21BigInt::FromDouble(123456789012345.0);
+  S21BigInt b(-98765432109876LL);
+  S21BigInt product = a * b * a * b * a;
+  ASSERT_EQ((product / b / a / a).ToString(), (a * b).ToString());
+  ASSERT_EQ((a + b).ToString(), "24691356902469");
+  ASSERT_EQ((b - a).ToString(), "-222222221122221");
+  ASSERT_EQ(S21BigInt(1000000000LL).ToString(), "1000000000");
+  ASSERT_EQ(S21BigInt(0).ToString(), "0");
+  ASSERT_DOUBLE_EQ((a * b).ToDouble(), 123456789012345.0 * -98765432109876.0);
+  EXPECT_ANY_THROW(a / S21BigInt(0));
+  EXPECT_ANY_THROW(S21BigInt::FromDouble(0.5));
+}
+
+TEST(DeterminantExact, Small) {
+  S21Matrix a(3, 3);
+  a(0, 0) = 2;
+  a(0, 1) = -3;
+  a(0, 2) = 1;
+  a(1, 0) = 2;
+  a(1, 1) = 0;
+  a(1, 2) = -1;
+  a(2, 0) = 1;
+  a(2, 1) = 4;
+  a(2, 2) = 5;
+  ASSERT_EQ(a.DeterminantExact().ToString(), "49");
+  S21Matrix swap(2, 2);
+  swap(0, 1) = swap(1, 0) = 1;
+  ASSERT_EQ(swap.DeterminantExact().ToString(), "-1");
+  S21Matrix singular(3, 3);
+  singular(0, 0) = singular(1, 0) = 1;
+  ASSERT_EQ(singular.DeterminantExact().ToString(), "0");
+}
+
+TEST(DeterminantExact, Large) {
+  // L * U, где L - единичная нижнетреугольная, на диагонали U тройки
+  int size = 100;
+  S21Matrix l(size, size), u(size, size);
+  for (int i = 0; i < size; i++) {
+    l(i, i) = 1;
+    u(i, i) = 3;
+    for (int j = 0; j < i; j++) l(i, j) = (i + j) % 3 - 1;
+    for (int j = i + 1; j < size; j++) u(i, j) = (i * j) % 5 - 2;
+  }
+  S21Matrix a = l * u;
+  ASSERT_EQ(a.DeterminantExact().ToString(),
+            "515377520732011331036461129765621272702107522001");
+}
+
+TEST(DeterminantExact, Errors) {
+  S21Matrix a(2, 2), b(2, 3);
+  a(0, 0) = 0.5;
+  EXPECT_ANY_THROW(a.DeterminantExact());
+  EXPECT_ANY_THROW(b.DeterminantExact());
+}
+
+TEST(Stats, Scope) {
+  S21MatrixStatsReset();
+  {
+    S21StatsScope scope(S21Op::kMulMatrix, 100, 2000, 2400);
+    S21StatsScope nested(S21Op::kSumMatrix, 100, 100, 2400);
+  }
+  S21StatsSnapshot snapshot = S21MatrixStatsSnapshot();
+  ASSERT_EQ(snapshot[S21Op::kMulMatrix].calls, 1u);
+  ASSERT_EQ(snapshot[S21Op::kMulMatrix].flops, 2000u);
+  ASSERT_EQ(snapshot[S21Op::kMulMatrix].bytes, 2400u);
+  ASSERT_EQ(snapshot[S21Op::kMulMatrix].elements_log2[6], 1u);
+  ASSERT_EQ(snapshot[S21Op::kSumMatrix].calls, 0u);
+  std::string json = S21MatrixStatsJson();
+  ASSERT_NE(json.find("\"MulMatrix\":{\"calls\":1,"), std::string::npos);
+  ASSERT_EQ(json.find("SumMatrix"), std::string::npos);
+  S21MatrixStatsReset();
+  ASSERT_EQ(S21MatrixStatsSnapshot()[S21Op::kMulMatrix].calls, 0u);
+  ASSERT_EQ(S21MatrixStatsJson(), "{\"operations\":{}}");
+}
+
+#ifdef S21_MATRIX_STATS
+TEST(Stats, MatrixMethods) {
+  S21MatrixStatsReset();
+  S21Matrix a = MakeInvertible(3), b = MakeInvertible(3);
+  a.MulMatrix(b);
+  a.InverseMatrix();
+  S21StatsSnapshot snapshot = S21MatrixStatsSnapshot();
+  ASSERT_EQ(snapshot[S21Op::kMulMatrix].calls, 1u);
+  ASSERT_EQ(snapshot[S21Op::kMulMatrix].flops, 54u);
+  ASSERT_EQ(snapshot[S21Op::kInverseMatrix].calls, 1u);
+  // Determinant внутри InverseMatrix отдельно не считается
+  ASSERT_EQ(snapshot[S21Op::kDeterminant].calls, 0u);
+}
+#endif
+
+TEST(Alloc, Counters) {
+  // без сброса счетчиков, чтобы make memprofile видел весь прогон тестов
+  S21AllocStats before = S21MatrixAllocStats();
+  std::size_t bytes = 6 * sizeof(double *) + 42 * sizeof(double);
+  {
+    S21Matrix a(6, 7);
+    S21AllocStats during = S21MatrixAllocStats();
+    ASSERT_EQ(during.allocations - before.allocations, 1u);
+    ASSERT_EQ(during.live_bytes - before.live_bytes, bytes);
+    ASSERT_GE(during.peak_bytes, before.live_bytes + bytes);
+  }
+  S21AllocStats after = S21MatrixAllocStats();
+  ASSERT_EQ(after.deallocations - before.deallocations, 1u);
+  ASSERT_EQ(after.live_bytes, before.live_bytes);
+  ASSERT_EQ(after.total_bytes - before.total_bytes, bytes);
+  ASSERT_NE(S21MatrixAllocReport().find("peak bytes"), std::string::npos);
+}
+
+TEST(Alloc, NoLeaksInOperators) {
+  uint64_t live = S21MatrixAllocStats().live_bytes;
+  {
+    S21Matrix a = MakeInvertible(6), b = MakeInvertible(6);
+    a.MulMatrix(b);
+    a = b * a;
+    a = a.InverseMatrix();
+    a.SetColumns(6);
+    a.SetRows(2);
+  }
+  ASSERT_EQ(S21MatrixAllocStats().live_bytes, live);
+}
+
+int allocator_calls = 0;
+
+void *CountingAllocate(std::size_t bytes, void *context) {
+  ++*static_cast<int *>(context);
+  return ::operator new(bytes);
+}
+
+void CountingDeallocate(void *ptr, std::size_t, void *context) {
+  --*static_cast<int *>(context);
+  ::operator delete(ptr);
+}
+
+TEST(Alloc, CustomAllocator) {
+  S21SetMatrixAllocator({CountingAllocate, CountingDeallocate,
+                         &allocator_calls});
+  {
+    S21Matrix a(5, 5), b(a), small(4, 4);
+    ASSERT_EQ(allocator_calls, 2);
+  }
+  ASSERT_EQ(allocator_calls, 0);
+  S21SetMatrixAllocator(S21DefaultMatrixAllocator());
+  EXPECT_ANY_THROW(S21SetMatrixAllocator({nullptr, nullptr, nullptr}));
+}
+
+TEST(Pool, ReusesBlocks) {
+  S21SetMatrixAllocator(S21PoolMatrixAllocator());
+  const double *first = nullptr;
+  {
+    S21Matrix a(8, 8);
+    first = &a(0, 0);
+  }
+  {
+    S21Matrix b(7, 9);  // тот же класс размера, блок начинается раньше
+    ASSERT_EQ(&b(0, 0) - 7, first - 8);  // элементов на число строк
+  }
+  {
+    S21Matrix a = MakeInvertible(5), b = MakeInvertible(5);
+    ASSERT_EQ((a * b).EqMatrix(a.Pow(2)), 1);
+    ASSERT_EQ((a + b).EqMatrix(a * 2), 1);
+  }
+  S21SetMatrixAllocator(S21DefaultMatrixAllocator());
+  S21MatrixPoolTrim();
+}
+
+TEST(Arena, BypassesAllocator) {
+  S21SetMatrixAllocator({CountingAllocate, CountingDeallocate,
+                         &allocator_calls});
+  S21Matrix outside = MakeInvertible(5);
+  S21Matrix *temporary = new S21Matrix(6, 6);
+  ASSERT_EQ(allocator_calls, 2);
+  {
+    S21MatrixArena scope(128);
+    S21Matrix a = MakeInvertible(5);
+    S21Matrix b = a * a + outside;
+    ASSERT_DOUBLE_EQ(b.Determinant(), (a * a + outside).Determinant());
+    {
+      S21MatrixArena nested;
+      S21Matrix c = b - a;
+      ASSERT_GT(nested.BytesUsed(), 0u);
+    }
+    ASSERT_GT(scope.BytesUsed(), 0u);
+    ASSERT_EQ(allocator_calls, 2);
+    delete temporary;  // блок не из арены возвращается аллокатору
+    ASSERT_EQ(allocator_calls, 1);
+  }
+  outside.MulNumber(2);
+  ASSERT_EQ(allocator_calls, 1);
+  S21SetMatrixAllocator(S21DefaultMatrixAllocator());
+}
+
+TEST(SmallMatrix, NoHeap) {
+  uint64_t allocations = S21MatrixAllocStats().allocations;
+  S21Matrix a, b(4, 4), c(2, 3);
+  b(3, 3) = 7;
+  S21Matrix moved(std::move(b));
+  S21Matrix product = moved * moved;
+  ASSERT_DOUBLE_EQ(moved(3, 3), 7);
+  ASSERT_DOUBLE_EQ(product(3, 3), 49);
+  ASSERT_EQ(S21MatrixAllocStats().allocations, allocations);
+  ASSERT_EQ(b.GetRows(), 0);
+}
+
+TEST(SmallMatrix, MixedWithHeap) {
+  S21Matrix small(2, 2), large(5, 5);
+  small(1, 1) = 3;
+  large(4, 4) = 5;
+  S21Matrix copy(large);
+  large = std::move(small);
+  ASSERT_EQ(large.GetRows(), 2);
+  ASSERT_DOUBLE_EQ(large(1, 1), 3);
+  small = std::move(copy);
+  ASSERT_EQ(small.GetRows(), 5);
+  ASSERT_DOUBLE_EQ(small(4, 4), 5);
+  small.SetRows(2);
+  small.SetColumns(2);
+  ASSERT_DOUBLE_EQ(small.Pow(3)(0, 0), 0);
+  large.SetColumns(6);
+  ASSERT_DOUBLE_EQ(large(1, 1), 3);
+}
+
+TEST(CopyOnWrite, SharesUntilWrite) {
+  S21Matrix a = MakeInvertible(6);
+  a.EnableCopyOnWrite(true);
+  uint64_t allocations = S21MatrixAllocStats().allocations;
+  S21Matrix b(a), c;
+  c = b;
+  ASSERT_TRUE(a.IsShared());
+  ASSERT_TRUE(c.IsCopyOnWrite());
+  ASSERT_EQ(S21MatrixAllocStats().allocations, allocations);
+
+  const S21Matrix &view = b;
+  ASSERT_DOUBLE_EQ(view(0, 0), 7);
+  ASSERT_EQ(S21MatrixAllocStats().allocations, allocations);
+
+  b(0, 0) = 100;
+  ASSERT_EQ(S21MatrixAllocStats().allocations, allocations + 1);
+  ASSERT_DOUBLE_EQ(a(0, 0), 7);
+  ASSERT_DOUBLE_EQ(c(0, 0), 7);
+  ASSERT_FALSE(b.IsShared());
+  c.MulNumber(2);
+  ASSERT_FALSE(a.IsShared());
+  ASSERT_DOUBLE_EQ(a(1, 1), 7);
+  ASSERT_DOUBLE_EQ(c(1, 1), 14);
+
+  // перемещение в общую матрицу не копирует буфер, который заменяется
+  S21Matrix d(a), e = MakeInvertible(6) * 2.0;
+  ASSERT_TRUE(d.IsShared());
+  allocations = S21MatrixAllocStats().allocations;
+  d = std::move(e);
+  ASSERT_EQ(S21MatrixAllocStats().allocations, allocations);
+  ASSERT_FALSE(a.IsShared());
+  ASSERT_DOUBLE_EQ(a(0, 0), 7);
+  ASSERT_DOUBLE_EQ(d(0, 0), 14);
+}
+
+TEST(CopyOnWrite, Operations) {
+  S21Matrix a = MakeInvertible(6), plain = MakeInvertible(6);
+  a.EnableCopyOnWrite(true);
+  ASSERT_EQ(a.Pow(5).EqMatrix(plain.Pow(5)), 1);
+  ASSERT_EQ(a.Exp().EqMatrix(plain.Exp()), 1);
+  ASSERT_EQ((a + a).EqMatrix(plain * 2), 1);
+  ASSERT_EQ(a.InverseMatrix().EqMatrix(plain.InverseMatrix()), 1);
+  S21MatrixInverse cached(a);
+  S21Matrix row(1, 6);
+  for (int j = 0; j < 6; j++) row(0, j) = j + 10;
+  cached.UpdateRow(0, row);
+  ASSERT_DOUBLE_EQ(cached.Matrix()(0, 5), 15);
+  ASSERT_EQ(a.EqMatrix(plain), 1);
+  S21Matrix moved(std::move(a));
+  ASSERT_TRUE(moved.IsCopyOnWrite());
+  moved.EnableCopyOnWrite(false);
+  ASSERT_FALSE(moved.IsCopyOnWrite());
+  ASSERT_EQ(moved.EqMatrix(plain), 1);
+}
+
+TEST(Async, Futures) {
+  S21Matrix a = MakeInvertible(5), b = MakeInvertible(5);
+  std::future<S21Matrix> product = a.MulMatrixAsync(b);
+  std::future<S21Matrix> inverse = a.InverseAsync();
+  std::future<double> det = a.DeterminantAsync();
+  std::future<S21Matrix> solution = a.SolveAsync(b);
+  ASSERT_EQ(product.get().EqMatrix(a * b), 1);
+  ASSERT_EQ(inverse.get().EqMatrix(a.InverseMatrix()), 1);
+  ASSERT_DOUBLE_EQ(det.get(), a.Determinant());
+  ASSERT_EQ(solution.get().EqMatrix(a.Solve(b)), 1);
+  EXPECT_THROW(a.MulMatrixAsync(S21Matrix(2, 2)).get(), std::invalid_argument);
+}
+
+TEST(Async, Callbacks) {
+  S21Matrix a = MakeInvertible(4);
+  std::promise<double> det_done;
+  a.DeterminantAsync([&det_done](double result, std::exception_ptr error) {
+    if (error) {
+      det_done.set_exception(error);
+    } else {
+      det_done.set_value(result);
+    }
+  });
+  ASSERT_DOUBLE_EQ(det_done.get_future().get(), a.Determinant());
+
+  std::promise<bool> inverse_done;
+  S21Matrix expected = a.InverseMatrix();
+  a.InverseAsync([&](S21Matrix result, std::exception_ptr error) {
+    inverse_done.set_value(!error && result.EqMatrix(expected));
+  });
+  ASSERT_TRUE(inverse_done.get_future().get());
+
+  std::promise<bool> failed;
+  a.MulMatrixAsync(S21Matrix(3, 3),
+                   [&failed](S21Matrix, std::exception_ptr error) {
+                     failed.set_value(error != nullptr);
+                   });
+  ASSERT_TRUE(failed.get_future().get());
+
+  // брошенное обработчиком не завершает программу, пул продолжает работать
+  a.DeterminantAsync([](double, std::exception_ptr) {
+    throw std::runtime_error("callback");
+  });
+  S21Matrix b = MakeInvertible(4) * a;
+  std::promise<bool> solved;
+  a.SolveAsync(b, [&](S21Matrix result, std::exception_ptr error) {
+    solved.set_value(!error && result.EqMatrix(a.Solve(b)));
+  });
+  ASSERT_TRUE(solved.get_future().get());
+}
+
+TEST(Async, InsideArena) {
+  // операнды уходят в пул и освобождаются там, а арена закрывается раньше
+  S21Matrix a = MakeInvertible(8);
+  S21Matrix expected = a.Transpose() * a, inverse = a.InverseMatrix();
+  std::future<S21Matrix> product, inverted;
+  std::promise<double> det_done;
+  {
+    S21MatrixArena scope;
+    S21Matrix x = a * 1.0, xt = x.Transpose();  // xt делит буфер с x
+    std::size_t used = scope.BytesUsed();
+    ASSERT_GT(used, 0u);
+    product = xt.MulMatrixAsync(x);
+    inverted = x.InverseAsync();
+    x.DeterminantAsync([&det_done](double result, std::exception_ptr) {
+      det_done.set_value(result);
+    });
+    ASSERT_EQ(scope.BytesUsed(), used);  // копии операндов мимо арены
+  }
+  ASSERT_EQ(product.get().EqMatrix(expected), 1);
+  ASSERT_EQ(inverted.get().EqMatrix(inverse), 1);
+  ASSERT_DOUBLE_EQ(det_done.get_future().get(), a.Determinant());
+}
+
+TEST(Async, Cancel) {
+  S21CancelToken early;
+  early.Cancel();
+  EXPECT_THROW(MakeInvertible(3).DeterminantAsync(early).get(), S21Cancelled);
+
+  // 13! миноров считались бы минуты, отмена прерывает рекурсию
+  S21CancelToken token;
+  std::future<double> det = MakeInvertible(13).DeterminantAsync(token);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  token.Cancel();
+  EXPECT_THROW(det.get(), S21Cancelled);
+  ASSERT_TRUE(token.IsCancelled());
+}
+
+TEST(TaskGroup, NestedForkJoin) {
+  // один рабочий поток: вложенные группы не должны блокировать друг друга
+  S21ThreadPool pool(1);
+  std::function<long(int)> fib = [&](int n) -> long {
+    if (n < 2) return n;
+    long left = 0, right = 0;
+    S21TaskGroup group(pool);
+    group.Run([&] { left = fib(n - 1); });
+    group.Run([&] { right = fib(n - 2); });
+    group.Wait();
+    return left + right;
+  };
+  ASSERT_EQ(fib(16), 987);
+}
+
+TEST(TaskGroup, ApplicationThreads) {
+  S21ThreadPool pool(2);
+  std::atomic<int> done{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, &done] {
+      S21TaskGroup group(pool);
+      for (int i = 0; i < 100; ++i) group.Run([&done] { ++done; });
+      group.Wait();
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+  ASSERT_EQ(done.load(), 400);
+}
+
+TEST(TaskGroup, WaitRunsOnlyOwnTasks) {
+  // единственный рабочий занят, чужая задача ждет в общей очереди
+  S21ThreadPool pool(1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::promise<std::thread::id> foreign;
+  pool.Submit([released] { released.wait(); });
+  pool.Submit([&foreign] { foreign.set_value(std::this_thread::get_id()); });
+  int sum = 0;
+  S21TaskGroup group(pool);
+  for (int i = 1; i <= 10; ++i) group.Run([&sum, i] { sum += i; });
+  group.Wait();  // свои задачи выполнены здесь же, чужая не тронута
+  ASSERT_EQ(sum, 55);
+  release.set_value();
+  ASSERT_NE(foreign.get_future().get(), std::this_thread::get_id());
+}
+
+TEST(TaskGroup, Errors) {
+  S21TaskGroup group;
+  group.Run([] { throw std::out_of_range("task"); });
+  group.Run([] {});
+  EXPECT_THROW(group.Wait(), std::out_of_range);
+  group.Run([] {});
+  EXPECT_NO_THROW(group.Wait());
+
+  S21CancelToken token;
+  token.Cancel();
+  S21CancelScope scope(token);
+  group.Run([] { S21CheckCancelled(); });
+  EXPECT_THROW(group.Wait(), S21Cancelled);
+
+  S21ThreadPool::Default();
+  EXPECT_THROW(S21ThreadPool::ConfigureDefault(2), std::logic_error);
+}
+
+TEST(TaskGroup, ParallelDeterminant) {
+  // треугольная матрица: определитель - произведение диагонали, 9! = 362880
+  S21Matrix a(9, 9);
+  for (int i = 0; i < 9; ++i) {
+    for (int j = i; j < 9; ++j) a(i, j) = i == j ? i + 1 : 0.5;
+  }
+  ASSERT_DOUBLE_EQ(a.Determinant(), 362880.0);
+
+  S21Matrix b = MakeInvertible(9);
+  S21Matrix complements = b.CalcComplements();
+  S21Matrix check = b.Transpose() * complements;
+  double det = b.Determinant();
+  for (int i = 0; i < 9; ++i) {
+    for (int j = 0; j < 9; ++j) {
+      ASSERT_NEAR(check(i, j), i == j ? det : 0.0, 1e-6 * std::fabs(det));
+    }
+  }
+}
+
+TEST(Policy, ElementWise) {
+  // 300x300 больше порога S21_PARALLEL_MIN_ELEMENTS
+  S21Matrix a(300, 300, S21ExecutionPolicy::kPar), b(300, 300);
+  ASSERT_DOUBLE_EQ(a(299, 299), 0.0);
+  for (int i = 0; i < 300; ++i) {
+    for (int j = 0; j < 300; ++j) {
+      a(i, j) = i - j;
+      b(i, j) = 0.5 * j;
+    }
+  }
+  for (S21ExecutionPolicy policy :
+       {S21ExecutionPolicy::kPar, S21ExecutionPolicy::kParUnseq}) {
+    S21Matrix expected(a), actual(a, policy);
+    ASSERT_TRUE(actual.EqMatrix(expected, policy));
+    expected.SumMatrix(b);
+    actual.SumMatrix(b, policy);
+    expected.MulNumber(-3.0);
+    actual.MulNumber(-3.0, policy);
+    expected.SubMatrix(a);
+    actual.SubMatrix(a, policy);
+    ASSERT_TRUE(actual.EqMatrix(expected));
+    actual(299, 299) += 1.0;
+    ASSERT_FALSE(actual.EqMatrix(expected, policy));
+    EXPECT_THROW(actual.SumMatrix(S21Matrix(3, 3), policy),
+                 std::invalid_argument);
+  }
+}
+
+TEST(Elementwise, ApplyZip) {
+  S21Matrix a(300, 300), b(300, 300);
+  a.Apply([](double) { return 2.0; }, S21ExecutionPolicy::kPar);
+  b.Apply([](double) { return 3.0; });
+  a.ZipWith(b, [](double x, double y) { return x * y + 1.0; },
+            S21ExecutionPolicy::kParUnseq);
+  ASSERT_DOUBLE_EQ(a(0, 0), 7.0);
+  ASSERT_DOUBLE_EQ(a(299, 299), 7.0);
+  EXPECT_THROW(a.ZipWith(S21Matrix(2, 2), [](double x, double) { return x; }),
+               std::invalid_argument);
+
+  // кеш сбрасывается, как и в остальных изменяющих методах
+  S21Matrix c = MakeInvertible(5);
+  c.EnableCache(true);
+  double det = c.Determinant();
+  c.Apply([](double x) { return 2.0 * x; });
+  ASSERT_NEAR(c.Determinant(), 32.0 * det, 1e-9 * std::fabs(det));
+}
+
+TEST(Elementwise, Reductions) {
+  S21Matrix a(3, 2);
+  a(0, 0) = 1, a(0, 1) = -2;
+  a(1, 0) = 3, a(1, 1) = 4;
+  a(2, 0) = -5, a(2, 1) = 6;
+  ASSERT_DOUBLE_EQ(a.Sum(), 7.0);
+  ASSERT_DOUBLE_EQ(a.Min(), -5.0);
+  ASSERT_DOUBLE_EQ(a.Max(), 6.0);
+  ASSERT_DOUBLE_EQ(a.Norm1(), 12.0);
+  ASSERT_DOUBLE_EQ(a.NormInf(), 11.0);
+  ASSERT_DOUBLE_EQ(a.NormFrobenius(), std::sqrt(91.0));
+  // A^T A = {{35, -20}, {-20, 56}}: след 91, определитель 1560
+  ASSERT_NEAR(a.Norm2(), std::sqrt((91.0 + std::sqrt(2041.0)) / 2.0), 1e-12);
+  ASSERT_DOUBLE_EQ(MakeInvertible(3).Trace(), 12.0);
+  EXPECT_THROW(a.Trace(), std::invalid_argument);
+  EXPECT_THROW(S21Matrix(0, 0).Min(), std::length_error);
+  ASSERT_DOUBLE_EQ(S21Matrix(0, 0).Sum(), 0.0);
+
+  // отображение и свертка за один проход: число положительных элементов
+  auto count = a.MapReduce([](double x) { return x > 0 ? 1 : 0; }, 0,
+                           std::plus<int>());
+  ASSERT_EQ(count, 4);
+
+  S21Matrix big(400, 400);
+  big.Apply([](double) { return 0.5; });
+  big(123, 45) = -7.0;
+  big(321, 54) = 9.0;
+  for (S21ExecutionPolicy policy :
+       {S21ExecutionPolicy::kPar, S21ExecutionPolicy::kParUnseq}) {
+    ASSERT_DOUBLE_EQ(big.Sum(policy), big.Sum());
+    ASSERT_DOUBLE_EQ(big.Min(policy), -7.0);
+    ASSERT_DOUBLE_EQ(big.Max(policy), 9.0);
+    ASSERT_DOUBLE_EQ(big.Norm1(policy), big.Norm1());
+    ASSERT_DOUBLE_EQ(big.NormInf(policy), big.NormInf());
+    ASSERT_DOUBLE_EQ(big.NormFrobenius(policy), big.NormFrobenius());
+  }
+}
+
+TEST(Gemm, Transposes) {
+  S21Matrix a(3, 4), b(4, 2), c(3, 2);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) a(i, j) = i * 4 + j - 5;
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 2; ++j) b(i, j) = 0.5 * (i - j) + 1;
+  }
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 2; ++j) c(i, j) = i + j;
+  }
+  S21Matrix expected = a * b * 2.0 + c * 0.5;
+  S21Matrix at = a.Transpose(), bt = b.Transpose();
+  for (int variant = 0; variant < 4; ++variant) {
+    bool trans_a = variant & 1, trans_b = variant & 2;
+    S21Matrix actual(c);
+    S21Matrix::Gemm(2.0, trans_a ? at : a, trans_a, trans_b ? bt : b,
+                    trans_b, 0.5, actual);
+    ASSERT_TRUE(actual.EqMatrix(expected)) << variant;
+  }
+  EXPECT_THROW(S21Matrix::Gemm(1.0, a, true, b, false, 0.0, c),
+               std::invalid_argument);
+  EXPECT_THROW(S21Matrix::Gemm(1.0, a, false, b, false, 0.0, at),
+               std::invalid_argument);
+
+  // beta == 0: мусор в c не читается
+  S21Matrix garbage(3, 2);
+  garbage.Apply([](double) { return std::nan(""); });
+  S21Matrix::Gemm(1.0, a, false, b, false, 0.0, garbage);
+  ASSERT_TRUE(garbage.EqMatrix(a * b));
+}
+
+TEST(Gemm, AliasingAndAxpy) {
+  S21Matrix a = MakeInvertible(5);
+  S21Matrix expected = a * a * 3.0 + a;
+  S21Matrix::Gemm(3.0, a, false, a, false, 1.0, a);
+  ASSERT_TRUE(a.EqMatrix(expected));
+
+  S21Matrix big = MakeInvertible(200), sq(200, 200), sq_par(200, 200);
+  S21Matrix::Gemm(1.0, big, true, big, false, 0.0, sq);
+  S21Matrix::Gemm(1.0, big, true, big, false, 0.0, sq_par,
+                  S21ExecutionPolicy::kPar);
+  ASSERT_TRUE(sq.EqMatrix(big.Transpose() * big));
+  ASSERT_TRUE(sq_par.EqMatrix(sq));
+
+  S21Matrix y = MakeInvertible(3), x = MakeInvertible(3);
+  y.Axpy(-2.0, x);
+  ASSERT_TRUE(y.EqMatrix(x * -1.0));
+  EXPECT_THROW(y.Axpy(1.0, S21Matrix(2, 2)), std::invalid_argument);
+}
+
+TEST(ProductChain, Plan) {
+  // классический пример: (A0 A1) A2 стоит 7500 умножений, A0 (A1 A2) - 75000
+  S21Matrix a(10, 100), b(100, 5), c(5, 50);
+  S21ProductChain chain = S21ProductChain(a) * b * c;
+  ASSERT_EQ(chain.GetCount(), 3);
+  ASSERT_EQ(chain.GetPlan(), "((A0 A1) A2)");
+  ASSERT_DOUBLE_EQ(chain.GetCost(), 7500.0);
+
+  // высокая и узкая матрица в начале: выгоднее умножать справа налево
+  S21Matrix tall(200, 2), wide(2, 200), square(200, 200), column(200, 1);
+  ASSERT_EQ((S21ProductChain(tall) * wide * square * column).GetPlan(),
+            "(A0 (A1 (A2 A3)))");
+
+  EXPECT_THROW(S21ProductChain(a) * c, std::invalid_argument);
+  EXPECT_THROW(S21ProductChain().Evaluate(), std::logic_error);
+}
+
+TEST(ProductChain, Evaluate) {
+  S21Matrix a(3, 6), b(6, 2), c(2, 5), d(5, 4);
+  int seed = 1;
+  for (S21Matrix *m : {&a, &b, &c, &d}) {
+    for (int i = 0; i < m->GetRows(); ++i) {
+      for (int j = 0; j < m->GetCols(); ++j) (*m)(i, j) = seed++ % 7 - 3;
+    }
+  }
+  S21Matrix expected = a * b * c * d;
+  S21Matrix actual = S21ProductChain(a) * b * c * d;
+  ASSERT_TRUE(actual.EqMatrix(expected));
+  ASSERT_TRUE(S21ProductChain(a).Evaluate().EqMatrix(a));
+  ASSERT_TRUE((S21ProductChain(a) * b)
+                  .Evaluate(S21ExecutionPolicy::kPar)
+                  .EqMatrix(a * b));
+}
+
+// несимметричная обратимая матрица и ее транспонированная копия,
+// построенная поэлементно
+void MakeLopsided(int size, S21Matrix &a, S21Matrix &a_t) {
+  a = MakeInvertible(size);
+  for (int i = 0; i < size; ++i) a(i, (i + 2) % size) += i + 1.5;
+  a_t = S21Matrix(size, size);
+  for (int i = 0; i < size; ++i) {
+    for (int j = 0; j < size; ++j) a_t(i, j) = a(j, i);
+  }
+}
+
+TEST(LazyTranspose, SharesBuffer) {
+  S21Matrix a(7, 5);
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 5; ++j) a(i, j) = i * 5 + j;
+  }
+  S21Matrix t = a.Transpose();
+  ASSERT_EQ(t.GetRows(), 5);
+  ASSERT_EQ(t.GetCols(), 7);
+  ASSERT_TRUE(t.IsShared());
+  const S21Matrix &ct = t;
+  ASSERT_DOUBLE_EQ(ct(4, 6), 34.0);
+  EXPECT_THROW(ct(6, 4), std::invalid_argument);
+
+  t(0, 1) = -1.0;  // запись отделяет копию
+  ASSERT_FALSE(t.IsShared());
+  ASSERT_DOUBLE_EQ(a(1, 0), 5.0);
+  ASSERT_DOUBLE_EQ(t(0, 1), -1.0);
+  ASSERT_TRUE(t.Transpose().Transpose().EqMatrix(t));
+
+  // чтение a через неконстантный operator() тоже отделяет копию
+  S21Matrix t2 = a.Transpose();
+  a(6, 4) = 100.0;
+  ASSERT_DOUBLE_EQ(t2(4, 6), 34.0);
+
+  t2.SetRows(3);
+  ASSERT_EQ(t2.GetRows(), 3);
+  ASSERT_EQ(t2.GetCols(), 7);
+  ASSERT_DOUBLE_EQ(t2(2, 6), 32.0);
+}
+
+TEST(LazyTranspose, ProductAllocatesOnlyResult) {
+  S21Matrix a = MakeInvertible(100);
+  S21Matrix at = a.Transpose();
+  S21AllocStats before = S21MatrixAllocStats();
+  S21Matrix product = at * a;  // A^T не материализуется
+  S21AllocStats after = S21MatrixAllocStats();
+  ASSERT_EQ(after.allocations - before.allocations, 1u);
+  ASSERT_EQ(after.total_bytes - before.total_bytes,
+            100 * sizeof(double *) + 100 * 100 * sizeof(double));
+  ASSERT_TRUE(at.IsShared());
+  before = after;
+  at.MulMatrix(a);
+  after = S21MatrixAllocStats();
+  ASSERT_EQ(after.allocations - before.allocations, 1u);
+  ASSERT_TRUE(at.EqMatrix(product));
+  ASSERT_FALSE(a.IsShared());
+}
+
+TEST(LazyTranspose, Kernels) {
+  S21Matrix a, a_t;
+  MakeLopsided(6, a, a_t);
+  S21Matrix t = a.Transpose();
+  ASSERT_TRUE(t.EqMatrix(a_t));
+  ASSERT_TRUE(a_t.EqMatrix(t));
+  ASSERT_FALSE(t.EqMatrix(a));
+
+  ASSERT_TRUE((t * a).EqMatrix(a_t * a));
+  ASSERT_TRUE((a * t).EqMatrix(a * a_t));
+  ASSERT_TRUE((t + a).EqMatrix(a_t + a));
+  ASSERT_TRUE((a - t).EqMatrix(a - a_t));
+  ASSERT_TRUE((t * 2.0).EqMatrix(a_t * 2.0));
+
+  S21Matrix b(6, 2);
+  for (int i = 0; i < 6; ++i) b(i, 0) = i, b(i, 1) = 1.0 - i;
+  ASSERT_TRUE(t.Solve(b).EqMatrix(a_t.Solve(b)));
+  ASSERT_TRUE(a_t.Solve(b.Transpose().Transpose()).EqMatrix(a_t.Solve(b)));
+  ASSERT_TRUE(t.SolveRefined(b).EqMatrix(a_t.Solve(b)));
+  t.EnableCache(true);
+  ASSERT_TRUE(t.Solve(b).EqMatrix(a_t.Solve(b)));
+  ASSERT_TRUE(t.Solve(b).EqMatrix(a_t.Solve(b)));  // из кеша LU
+
+  ASSERT_NEAR(t.Determinant(), a_t.Determinant(), 1e-9);
+  ASSERT_TRUE(t.InverseMatrix().EqMatrix(a_t.InverseMatrix()));
+  ASSERT_TRUE(t.CalcComplements().EqMatrix(a_t.CalcComplements()));
+  ASSERT_TRUE(t.Submatrix(1, 4).EqMatrix(a_t.Submatrix(1, 4)));
+  ASSERT_TRUE(t.Pow(3).EqMatrix(a_t.Pow(3)));
+  ASSERT_TRUE(t.Pow(-2).EqMatrix(a_t.Pow(-2)));
+  ASSERT_TRUE(t.Exp().EqMatrix(a_t.Exp()));
+  ASSERT_DOUBLE_EQ(t.Norm1(), a_t.Norm1());
+  ASSERT_DOUBLE_EQ(t.NormInf(), a_t.NormInf());
+  ASSERT_DOUBLE_EQ(t.Trace(), a_t.Trace());
+}
+
+TEST(LazyTranspose, GemmAndInverse) {
+  S21Matrix a, a_t;
+  MakeLopsided(5, a, a_t);
+  S21Matrix c = S21Matrix(5, 5).Transpose(), expected = a_t * a;
+  S21Matrix::Gemm(1.0, a.Transpose(), false, a, false, 0.0, c);
+  ASSERT_TRUE(c.EqMatrix(expected));
+  S21Matrix::Gemm(1.0, a, true, a.Transpose(), true, 1.0, c);
+  ASSERT_TRUE(c.EqMatrix(expected * 2.0));
+
+  S21MatrixInverse inverse(a.Transpose());
+  ASSERT_TRUE(inverse.Inverse().EqMatrix(a_t.InverseMatrix()));
+  S21Matrix row(5, 1);
+  for (int i = 0; i < 5; ++i) row(i, 0) = 0.1 * i;
+  inverse.UpdateRow(2, row.Transpose());
+  for (int j = 0; j < 5; ++j) a_t(2, j) = 0.1 * j;
+  ASSERT_TRUE(inverse.Inverse().EqMatrix(a_t.InverseMatrix()));
+}
+
+TEST(Layout, ConvertAndExchange) {
+  // 2 x 3 по столбцам, как его отдал бы Fortran
+  const double fortran[] = {1, 4, 2, 5, 3, 6};
+  S21Matrix a = S21Matrix::FromBuffer(fortran, 2, 3, S21Layout::kColMajor);
+  ASSERT_EQ(a.GetLayout(), S21Layout::kColMajor);
+  ASSERT_EQ(a.GetRows(), 2);
+  ASSERT_DOUBLE_EQ(a(0, 2), 3.0);
+  ASSERT_DOUBLE_EQ(a(1, 0), 4.0);
+
+  double out[6];
+  a.ToBuffer(out, S21Layout::kRowMajor);
+  for (int i = 0; i < 6; ++i) ASSERT_DOUBLE_EQ(out[i], i + 1.0);
+  a.ToBuffer(out, S21Layout::kColMajor);
+  for (int i = 0; i < 6; ++i) ASSERT_DOUBLE_EQ(out[i], fortran[i]);
+
+  S21Matrix b = S21Matrix::FromBuffer(out, 2, 3, S21Layout::kColMajor);
+  S21Matrix rows = a.InLayout(S21Layout::kRowMajor);
+  ASSERT_EQ(rows.GetLayout(), S21Layout::kRowMajor);
+  ASSERT_TRUE(rows.EqMatrix(b));
+  b.ConvertTo(S21Layout::kRowMajor);
+  b.ConvertTo(S21Layout::kRowMajor);
+  ASSERT_EQ(b.GetLayout(), S21Layout::kRowMajor);
+  ASSERT_TRUE(b.EqMatrix(a));
+  ASSERT_TRUE(a.Transpose().GetLayout() == S21Layout::kRowMajor);
+
+  S21Matrix c(3, 2, S21Layout::kColMajor);
+  c(2, 1) = 7.0;
+  ASSERT_DOUBLE_EQ(c.Transpose()(1, 2), 7.0);
+  ASSERT_TRUE((a * c).EqMatrix(rows * c.InLayout(S21Layout::kRowMajor)));
+}
+
+TEST(Layout, SlicesAndScaling) {
+  S21Matrix a, a_t;
+  MakeLopsided(4, a, a_t);
+  S21Matrix col = a;
+  col.ConvertTo(S21Layout::kColMajor);
+  for (int k = 0; k < 4; ++k) {
+    S21Matrix row = a.Row(k), row_c = col.Row(k);
+    S21Matrix column = a.Column(k), column_c = col.Column(k);
+    for (int j = 0; j < 4; ++j) {
+      ASSERT_DOUBLE_EQ(row(0, j), a(k, j));
+      ASSERT_DOUBLE_EQ(row_c(0, j), a(k, j));
+      ASSERT_DOUBLE_EQ(column(j, 0), a(j, k));
+      ASSERT_DOUBLE_EQ(column_c(j, 0), a(j, k));
+    }
+  }
+  EXPECT_THROW(a.Row(4), std::out_of_range);
+  EXPECT_THROW(col.Column(-1), std::out_of_range);
+
+  std::vector<double> factors = {1.0, -2.0, 0.5, 3.0};
+  S21Matrix expected = a;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) expected(i, j) *= factors[i] * factors[j];
+  }
+  a.ScaleRows(factors);
+  a.ScaleColumns(factors);
+  col.ScaleColumns(factors);
+  col.ScaleRows(factors);
+  ASSERT_TRUE(a.EqMatrix(expected));
+  ASSERT_TRUE(col.EqMatrix(expected));
+  EXPECT_THROW(a.ScaleRows({1.0}), std::invalid_argument);
+}
+
+TEST(ExternalBuffer, View) {
+  // 3 x 4 внутри буфера с шагом 5: последний столбец - чужие данные
+  std::vector<double> buffer(15);
+  for (int i = 0; i < 15; ++i) buffer[i] = i;
+  S21Matrix view(buffer.data(), 3, 4, 5);
+  ASSERT_TRUE(view.IsView());
+  ASSERT_EQ(view.Stride(), 5);
+  ASSERT_EQ(view.Data(), buffer.data());
+  ASSERT_DOUBLE_EQ(view(2, 3), 13.0);
+
+  view(1, 0) = -1.0;  // запись идет в буфер
+  ASSERT_DOUBLE_EQ(buffer[5], -1.0);
+  view.MulNumber(2.0);
+  ASSERT_DOUBLE_EQ(buffer[14], 14.0);
+  ASSERT_DOUBLE_EQ(buffer[13], 26.0);
+
+  S21Matrix copy(view);
+  ASSERT_FALSE(copy.IsView());
+  ASSERT_EQ(copy.Stride(), 4);
+  ASSERT_TRUE(copy.EqMatrix(view));
+  copy(0, 0) = 100.0;
+  ASSERT_DOUBLE_EQ(buffer[0], 0.0);
+  S21Matrix transposed = view.Transpose();  // вид транспонируется копией
+  ASSERT_FALSE(transposed.IsView());
+  ASSERT_DOUBLE_EQ(transposed(3, 2), 26.0);
+
+  // Фортрановский массив 2 x 3 с ведущей размерностью 4
+  double fortran[12] = {1, 2, 0, 0, 3, 4, 0, 0, 5, 6, 0, 0};
+  S21Matrix column_view(fortran, 2, 3, 4, S21Layout::kColMajor);
+  ASSERT_EQ(column_view.GetLayout(), S21Layout::kColMajor);
+  ASSERT_DOUBLE_EQ(column_view(1, 2), 6.0);
+  ASSERT_DOUBLE_EQ(column_view.Sum(), 21.0);
+
+  EXPECT_THROW(S21Matrix(buffer.data(), 3, 4, 3), std::invalid_argument);
+  EXPECT_THROW(S21Matrix(nullptr, 3, 4, 4), std::invalid_argument);
+}
+
+TEST(ExternalBuffer, RowTableOnly) {
+  // у вида в куче только таблица строк, и она же освобождается
+  std::vector<double> buffer(100 * 100);
+  S21AllocStats before = S21MatrixAllocStats();
+  {
+    S21Matrix view(buffer.data(), 100, 100, 100);
+    S21AllocStats during = S21MatrixAllocStats();
+    ASSERT_EQ(during.live_bytes - before.live_bytes, 100 * sizeof(double *));
+  }
+  ASSERT_EQ(S21MatrixAllocStats().live_bytes, before.live_bytes);
+}
+
+TEST(ExternalBuffer, Deleter) {
+  int released = 0;
+  double *data = new double[36]();
+  {
+    S21Matrix view(data, 6, 6, 6, [&released](double *p) {
+      ++released;
+      delete[] p;
+    });
+    S21Matrix moved(std::move(view));
+    ASSERT_TRUE(moved.IsView());
+    ASSERT_EQ(released, 0);
+    moved = MakeInvertible(6);  // переназначение отпускает буфер
+    ASSERT_EQ(released, 1);
+    ASSERT_FALSE(moved.IsView());
+  }
+  ASSERT_EQ(released, 1);
+
+  S21Matrix a = MakeInvertible(6);
+  a.EnableCopyOnWrite(true);
+  S21Matrix b(a);
+  ASSERT_TRUE(b.IsShared());
+  const S21Matrix &cb = b;
+  ASSERT_EQ(cb.Data(), static_cast<const S21Matrix &>(a).Data());
+  b.Data()[0] = 42.0;  // неконстантный Data() отделяет копию
+  ASSERT_DOUBLE_EQ(b(0, 0), 42.0);
+  ASSERT_DOUBLE_EQ(a(0, 0), 7.0);
+}
+
+// Матрица rows x cols в буфере BLAS с ведущей размерностью ld, лишние
+// элементы заполнены мусором
+std::vector<double> ToBlas(const S21Matrix &m, int layout, int ld) {
+  int rows = m.GetRows(), cols = m.GetCols();
+  bool row_major = layout == CblasRowMajor;
+  std::vector<double> buffer(ld * (row_major ? rows : cols), -777.0);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      buffer[row_major ? i * ld + j : j * ld + i] = m(i, j);
+    }
+  }
+  return buffer;
+}
+
+S21Matrix FromBlas(const std::vector<double> &buffer, int layout, int rows,
+                   int cols, int ld) {
+  S21Matrix m(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      m(i, j) = buffer[layout == CblasRowMajor ? i * ld + j : j * ld + i];
+    }
+  }
+  return m;
+}
+
+S21Matrix MakeWavy(int rows, int cols, int seed) {
+  S21Matrix m(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      m(i, j) = std::sin(seed + 1.3 * i + 0.7 * j + 0.37 * i * j);
+    }
+  }
+  return m;
+}
+
+TEST(BlasShim, Gemm) {
+  S21Matrix a = MakeWavy(5, 7, 1), b = MakeWavy(7, 4, 2), c = MakeWavy(5, 4, 3);
+  S21Matrix expected = a * b * 2.0 + c * 0.5;
+  for (int layout : {CblasRowMajor, CblasColMajor}) {
+    for (bool trans_a : {false, true}) {
+      for (bool trans_b : {false, true}) {
+        S21Matrix stored_a = trans_a ? S21Matrix(a).Transpose() : a;
+        S21Matrix stored_b = trans_b ? S21Matrix(b).Transpose() : b;
+        std::vector<double> buf_a = ToBlas(stored_a, layout, 9);
+        std::vector<double> buf_b = ToBlas(stored_b, layout, 8);
+        std::vector<double> buf_c = ToBlas(c, layout, 6);
+        cblas_dgemm(CBLAS_LAYOUT(layout), trans_a ? CblasTrans : CblasNoTrans,
+                    trans_b ? CblasTrans : CblasNoTrans, 5, 4, 7, 2.0,
+                    buf_a.data(), 9, buf_b.data(), 8, 0.5, buf_c.data(), 6);
+        ASSERT_TRUE(FromBlas(buf_c, layout, 5, 4, 6).EqMatrix(expected));
+        // паддинг между строками не тронут
+        ASSERT_DOUBLE_EQ(buf_c[5], -777.0);
+      }
+    }
+  }
+  std::vector<double> buf_c(20, std::nan(""));
+  std::vector<double> buf_a = ToBlas(a, CblasRowMajor, 7);
+  std::vector<double> buf_b = ToBlas(b, CblasRowMajor, 4);
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 5, 4, 7, 1.0,
+              buf_a.data(), 7, buf_b.data(), 4, 0.0, buf_c.data(), 4);
+  ASSERT_TRUE(FromBlas(buf_c, CblasRowMajor, 5, 4, 4).EqMatrix(a * b));
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 5, 4, 0, 1.0,
+              buf_a.data(), 7, buf_b.data(), 4, 0.0, buf_c.data(), 4);
+  ASSERT_DOUBLE_EQ(buf_c[7], 0.0);
+  // неверная ведущая размерность: c не меняется
+  cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, 5, 4, 7, 1.0,
+              buf_a.data(), 3, buf_b.data(), 4, 0.0, buf_c.data(), 4);
+  ASSERT_DOUBLE_EQ(buf_c[7], 0.0);
+}
+
+TEST(BlasShim, Vectors) {
+  S21Matrix a = MakeWavy(6, 4, 4);
+  std::vector<double> buf_a = ToBlas(a, CblasColMajor, 6);
+  // x = (1, 2, 3, 4) с шагом 2, y с шагом -1
+  double x[8] = {1, 0, 2, 0, 3, 0, 4, 0};
+  double y[6] = {1, 1, 1, 1, 1, 1};
+  cblas_dgemv(CblasColMajor, CblasNoTrans, 6, 4, 1.0, buf_a.data(), 6, x, 2,
+              3.0, y, -1);
+  for (int i = 0; i < 6; ++i) {
+    double sum = 3.0;
+    for (int j = 0; j < 4; ++j) sum += a(i, j) * (j + 1);
+    ASSERT_NEAR(y[5 - i], sum, 1e-12);
+  }
+  double z[4] = {0, 0, 0, 0};
+  cblas_dgemv(CblasRowMajor, CblasTrans, 4, 2, 1.0, x, 2, y, 1, 0.0, z, 1);
+  ASSERT_DOUBLE_EQ(z[0], 1 * y[0] + 2 * y[1] + 3 * y[2] + 4 * y[3]);
+
+  double u[3] = {1, 2, 3}, v[6] = {10, 0, 20, 0, 30, 0};
+  cblas_daxpy(3, 2.0, u, 1, v, -2);
+  ASSERT_DOUBLE_EQ(v[0], 16.0);
+  ASSERT_DOUBLE_EQ(v[4], 32.0);
+  cblas_daxpy(3, 1.0, u, 1, v, 0);
+  ASSERT_DOUBLE_EQ(v[0], 22.0);
+  cblas_dscal(3, -1.0, v, 2);
+  ASSERT_DOUBLE_EQ(v[2], -24.0);
+  ASSERT_DOUBLE_EQ(v[1], 0.0);
+}
+
+TEST(BlasShim, LuSolve) {
+  const int n = 150, nrhs = 3;
+  S21Matrix a = MakeWavy(n, n, 5);
+  S21Matrix x = MakeWavy(n, nrhs, 6);
+  for (int layout : {LAPACK_ROW_MAJOR, LAPACK_COL_MAJOR}) {
+    for (char trans : {'N', 'T'}) {
+      S21Matrix op_a = trans == 'N' ? a : S21Matrix(a).Transpose();
+      std::vector<double> buf_a = ToBlas(a, layout, n + 3);
+      int ldb = layout == LAPACK_ROW_MAJOR ? 5 : n;
+      S21Matrix b = op_a * x;
+      std::vector<double> buf_b = ToBlas(b, layout, ldb);
+      std::vector<int> ipiv(n);
+      ASSERT_EQ(LAPACKE_dgetrf(layout, n, n, buf_a.data(), n + 3, ipiv.data()),
+                0);
+      ASSERT_EQ(LAPACKE_dgetrs(layout, trans, n, nrhs, buf_a.data(), n + 3,
+                               ipiv.data(), buf_b.data(), ldb),
+                0);
+      // невязка, а не ошибка: матрица плохо обусловлена
+      S21Matrix residual = op_a * FromBlas(buf_b, layout, n, nrhs, ldb) - b;
+      ASSERT_LT(residual.NormInf(), 1e-9);
+    }
+  }
+  // прямоугольная 2 x 3 и вырожденная матрица
+  double rect[6] = {1, 2, 3, 2, 4, 7};
+  int ipiv[3];
+  ASSERT_EQ(LAPACKE_dgetrf(LAPACK_ROW_MAJOR, 2, 3, rect, 3, ipiv), 2);
+  ASSERT_EQ(ipiv[0], 2);
+  ASSERT_DOUBLE_EQ(rect[3], 0.5);
+  ASSERT_DOUBLE_EQ(rect[5], -0.5);
+  ASSERT_EQ(LAPACKE_dgetrf(LAPACK_ROW_MAJOR, 2, 3, rect, 2, ipiv), -5);
+  ASSERT_EQ(LAPACKE_dgetrs(LAPACK_COL_MAJOR, 'X', 2, 1, rect, 2, ipiv, rect,
+                           2),
+            -2);
+  ASSERT_EQ(LAPACKE_dgetrf(7, 2, 3, rect, 3, ipiv), -1);
+
+  // отмена внутри Gemm не пересекает границу C, а становится кодом ошибки
+  S21CancelToken token;
+  token.Cancel();
+  S21CancelScope scope(token);
+  std::vector<double> buf_a = ToBlas(a, LAPACK_ROW_MAJOR, n);
+  std::vector<int> pivots(n);
+  ASSERT_EQ(LAPACKE_dgetrf(LAPACK_ROW_MAJOR, n, n, buf_a.data(), n,
+                           pivots.data()),
+            S21_LAPACK_INTERNAL_ERROR);
+}
+
+TEST(BlasShim, Cholesky) {
+  const int n = 130;
+  S21Matrix g = MakeWavy(n, n, 7);
+  S21Matrix spd(n, n);
+  S21Matrix::Gemm(1.0, g, false, g, true, 0.0, spd);
+  for (int i = 0; i < n; ++i) spd(i, i) += n;
+  for (int layout : {LAPACK_ROW_MAJOR, LAPACK_COL_MAJOR}) {
+    for (char uplo : {'L', 'U'}) {
+      std::vector<double> buffer = ToBlas(spd, layout, n + 1);
+      ASSERT_EQ(LAPACKE_dpotrf(layout, uplo, n, buffer.data(), n + 1), 0);
+      S21Matrix factor = FromBlas(buffer, layout, n, n, n + 1);
+      for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+          int r = uplo == 'L' ? i : j, c = uplo == 'L' ? j : i;
+          ASSERT_DOUBLE_EQ(factor(r, c), spd(r, c));  // не тронут
+          factor(r, c) = 0.0;
+        }
+      }
+      S21Matrix product(n, n);
+      S21Matrix::Gemm(1.0, factor, uplo == 'U', factor, uplo == 'L', 0.0,
+                      product);
+      ASSERT_TRUE(product.EqMatrix(spd));
+    }
+  }
+  double indefinite[4] = {1, 2, 2, 1};
+  ASSERT_EQ(LAPACKE_dpotrf(LAPACK_ROW_MAJOR, 'U', 2, indefinite, 2), 2);
+  ASSERT_EQ(LAPACKE_dpotrf(LAPACK_ROW_MAJOR, 'Q', 2, indefinite, 2), -2);
+}
+
+TEST(OutOfCore, MappedFile) {
+  S21Matrix m = MakeWavy(13, 9, 8);
+  {
+    S21MappedMatrix saved = S21MappedMatrix::Save("test_mapped.bin", m);
+    saved.PrefetchTile(4, 2, 3, 5);  // только подсказка, данные не меняет
+    S21Matrix tile = saved.Tile(4, 2, 3, 5);
+    ASSERT_TRUE(tile.IsView());
+    tile(0, 0) = 42.0;  // пишет прямо в файл
+    EXPECT_THROW(saved.Tile(10, 0, 4, 1), std::invalid_argument);
+  }
+  S21MappedMatrix opened = S21MappedMatrix::Open("test_mapped.bin");
+  ASSERT_EQ(opened.GetRows(), 13);
+  ASSERT_EQ(opened.GetCols(), 9);
+  m(4, 2) = 42.0;
+  S21Matrix loaded = opened.Load();
+  ASSERT_FALSE(loaded.IsView());
+  ASSERT_TRUE(loaded.EqMatrix(m));
+  std::remove("test_mapped.bin");
+
+  EXPECT_THROW(S21MappedMatrix::Open("test_missing.bin"), std::system_error);
+  S21FileMapping::Create("test_junk.bin", 40);
+  EXPECT_THROW(S21MappedMatrix::Open("test_junk.bin"), std::invalid_argument);
+
+  // rows * cols * 8 переполняет size_t ровно до 64 байт данных
+  const std::int32_t shape[3] = {2147352580, 1073807362, 0};
+  {
+    std::ofstream out("test_junk.bin", std::ios::binary);
+    out << "S21M";
+    out.write(reinterpret_cast<const char *>(shape), sizeof(shape));
+    out << std::string(64, '\0');
+  }
+  EXPECT_THROW(S21MappedMatrix::Open("test_junk.bin"), std::invalid_argument);
+  EXPECT_THROW(
+      S21MappedMatrix::Create("test_junk.bin", 2147352580, 1073807362),
+      std::invalid_argument);
+  std::remove("test_junk.bin");
+}
+
+TEST(OutOfCore, Multiply) {
+  S21Matrix a = MakeWavy(30, 25, 9), b = MakeWavy(25, 19, 10);
+  S21MappedMatrix file_a = S21MappedMatrix::Save("test_ooc_a.bin", a);
+  S21MappedMatrix file_b = S21MappedMatrix::Save("test_ooc_b.bin", b);
+  S21MappedMatrix file_c = S21MappedMatrix::Create("test_ooc_c.bin", 30, 19);
+  // плитка 7: неполные плитки по всем трем измерениям
+  std::size_t budget = 6 * 7 * 7 * sizeof(double);
+  ASSERT_EQ(S21OutOfCoreTile(budget), 7);
+  S21MultiplyOutOfCore(file_a, file_b, file_c, budget);
+  file_c.Flush();
+  ASSERT_TRUE(S21MappedMatrix::Open("test_ooc_c.bin").Load().EqMatrix(a * b));
+  {
+    // плитки освобождаются в пуле, поэтому арена вызывающего потока им не
+    // достается
+    S21MatrixArena scope;
+    S21MultiplyOutOfCore(file_a, file_b, file_c, budget);
+  }
+  ASSERT_TRUE(S21MappedMatrix::Open("test_ooc_c.bin").Load().EqMatrix(a * b));
+
+  EXPECT_THROW(S21MultiplyOutOfCore(file_a, file_b, file_c, 16),
+               std::invalid_argument);
+  EXPECT_THROW(S21MultiplyOutOfCore(file_b, file_a, file_c, budget),
+               std::invalid_argument);
+  std::remove("test_ooc_a.bin");
+  std::remove("test_ooc_b.bin");
+  std::remove("test_ooc_c.bin");
+}
+
+TEST(Npy, SaveLoadMap) {
+  S21Matrix m = MakeWavy(7, 5, 11);
+  S21Matrix fortran = m.InLayout(S21Layout::kColMajor);
+  S21SaveNpy("test_c.npy", m);
+  S21SaveNpy("test_f.npy", fortran);
+  S21SaveNpy("test_f4.npy", m, S21NpyType::kFloat32);
+
+  ASSERT_TRUE(S21LoadNpy("test_c.npy").EqMatrix(m));
+  S21Matrix mapped = S21MapNpy("test_f.npy");
+  ASSERT_TRUE(mapped.IsView());
+  ASSERT_EQ(mapped.GetLayout(), S21Layout::kColMajor);
+  ASSERT_TRUE(mapped.EqMatrix(m));
+  // файл открыт на чтение: запись не падает и в файл не попадает
+  mapped(1, 2) = 42.0;
+  mapped.MulNumber(2.0);
+  ASSERT_DOUBLE_EQ(mapped(1, 2), 84.0);
+  ASSERT_TRUE(S21LoadNpy("test_f.npy").EqMatrix(m));
+  S21Matrix narrow = S21MapNpy("test_f4.npy");  // float32 - копия
+  ASSERT_FALSE(narrow.IsView());
+  ASSERT_NEAR(narrow(6, 4), m(6, 4), 1e-6);
+
+  {
+    S21Matrix writable = S21MapNpy("test_c.npy", true);
+    writable(2, 3) = 42.0;
+  }
+  ASSERT_DOUBLE_EQ(S21LoadNpy("test_c.npy")(2, 3), 42.0);
+  std::remove("test_c.npy");
+  std::remove("test_f.npy");
+  std::remove("test_f4.npy");
+}
+
+TEST(Npy, ForeignHeader) {
+  // float32 со старшим байтом первым, Fortran, одномерный массив (3,)
+  std::string dict = "{'descr': '>f4', 'fortran_order': True, 'shape': (3,), }";
+  std::string npy = std::string("\x93NUMPY\x01\x00", 8);
+  npy += static_cast<char>(dict.size() + 1);
+  npy += '\0';
+  npy += dict + "\n";
+  for (float value : {1.5f, -2.0f, 3.25f}) {
+    char bytes[4];
+    std::memcpy(bytes, &value, 4);
+    std::reverse(bytes, bytes + 4);
+    npy.append(bytes, 4);
+  }
+  {
+    std::ofstream out("test_foreign.npy", std::ios::binary);
+    out << npy;
+  }
+  S21Matrix column = S21MapNpy("test_foreign.npy");
+  ASSERT_EQ(column.GetRows(), 3);
+  ASSERT_EQ(column.GetCols(), 1);
+  ASSERT_DOUBLE_EQ(column(2, 0), 3.25);
+  ASSERT_DOUBLE_EQ(column(1, 0), -2.0);
+
+  npy[22] = 'i';  // '>i4'
+  {
+    std::ofstream out("test_foreign.npy", std::ios::binary);
+    out << npy;
+  }
+  EXPECT_THROW(S21LoadNpy("test_foreign.npy"), std::invalid_argument);
+
+  // размер данных по такой форме переполняет size_t ровно до 64 байт
+  dict = "{'descr': '<f8', 'fortran_order': False, "
+         "'shape': (2147352580, 1073807362), }";
+  npy = std::string("\x93NUMPY\x01\x00", 8);
+  npy += static_cast<char>(dict.size() + 1);
+  npy += '\0';
+  npy += dict + "\n" + std::string(64, '\0');
+  {
+    std::ofstream out("test_foreign.npy", std::ios::binary);
+    out << npy;
+  }
+  EXPECT_THROW(S21LoadNpy("test_foreign.npy"), std::invalid_argument);
+  EXPECT_THROW(S21MapNpy("test_foreign.npy"), std::invalid_argument);
+  std::remove("test_foreign.npy");
+}
+
+TEST(Npy, Archive) {
+  std::map<std::string, S21Matrix> arrays;
+  arrays.emplace("weights", MakeWavy(4, 6, 12));
+  arrays.emplace("bias", MakeWavy(6, 1, 13));
+  arrays.emplace("t", MakeWavy(3, 2, 14).Transpose());
+  S21SaveNpz("test_arrays.npz", arrays);
+  std::map<std::string, S21Matrix> loaded = S21LoadNpz("test_arrays.npz");
+  ASSERT_EQ(loaded.size(), 3u);
+  for (const auto &[name, m] : arrays) {
+    ASSERT_TRUE(loaded.at(name).EqMatrix(m));
+  }
+  ASSERT_EQ(loaded.at("t").GetLayout(), S21Layout::kColMajor);
+  std::remove("test_arrays.npz");
+  EXPECT_THROW(S21LoadNpz("test_arrays.npz"), std::system_error);
+
+  // запись каталога с полем ZIP64 короче объявленных в ней значений
+  auto put = [](std::string &out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out += static_cast<char>(value >> 8 * i);
+  };
+  auto archive = [&put](int field_bytes, int extra_bytes) {
+    std::string zip;
+    put(zip, 0x02014b50, 4);
+    put(zip, 20, 2);
+    put(zip, 20, 2);
+    put(zip, 0, 4);  // флаги и метод
+    put(zip, 0, 8);  // время, дата и CRC
+    put(zip, 0xFFFFFFFF, 4);  // сжатый размер
+    put(zip, 0xFFFFFFFF, 4);  // размер
+    put(zip, 5, 2);  // длина имени
+    put(zip, extra_bytes, 2);
+    put(zip, 0, 8);  // комментарий, диск, атрибуты
+    put(zip, 0, 4);
+    put(zip, 0xFFFFFFFF, 4);  // смещение
+    zip += "a.npy";
+    put(zip, 1, 2);
+    put(zip, field_bytes, 2);
+    zip += std::string(extra_bytes - 4, '\0');
+    std::uint32_t directory = zip.size();
+    put(zip, 0x06054b50, 4);
+    put(zip, 0, 4);
+    put(zip, 1, 2);
+    put(zip, 1, 2);
+    put(zip, directory, 4);
+    put(zip, 0, 4);
+    put(zip, 0, 2);
+    std::ofstream("test_zip64.npz", std::ios::binary) << zip;
+  };
+  archive(8, 12);  // нужно три значения, в поле одно
+  EXPECT_THROW(S21LoadNpz("test_zip64.npz"), std::invalid_argument);
+  archive(24, 12);  // поле длиннее дополнительных данных записи
+  EXPECT_THROW(S21LoadNpz("test_zip64.npz"), std::invalid_argument);
+  std::remove("test_zip64.npz");
+}
+
+TEST(Market, Dataset) {
+  std::variant<S21Matrix, S21SparseMatrix> loaded =
+      S21LoadMarket("../datasets/laplace_1d_6.mtx");
+  ASSERT_TRUE(std::holds_alternative<S21Matrix>(loaded));
+  const S21Matrix &dense = std::get<S21Matrix>(loaded);
+  ASSERT_DOUBLE_EQ(dense(3, 3), 2.0);
+  ASSERT_DOUBLE_EQ(dense(2, 3), -1.0);  // симметричная половина
+  ASSERT_DOUBLE_EQ(dense(0, 5), 0.0);
+
+  S21SparseMatrix sparse = S21ReadMarketSparse("../datasets/laplace_1d_6.mtx");
+  ASSERT_EQ(sparse.GetNonZeros(), 16u);
+  ASSERT_TRUE(sparse.ToDense().EqMatrix(dense));
+  ASSERT_DOUBLE_EQ(sparse(4, 3), -1.0);
+  S21Matrix ones(6, 1);
+  ones.Apply([](double) { return 1.0; });
+  S21Matrix product = sparse.Multiply(ones, S21ExecutionPolicy::kPar);
+  ASSERT_DOUBLE_EQ(product(0, 0), 1.0);
+  ASSERT_DOUBLE_EQ(product(2, 0), 0.0);
+  ASSERT_DOUBLE_EQ(product(5, 0), 1.0);
+}
+
+TEST(Market, RoundTrip) {
+  // ~2 МБ текста: разбирается несколькими кусками
+  S21Matrix m = MakeWavy(300, 300, 15);
+  S21WriteMarket("test_dense.mtx", m);
+  S21Matrix read = S21ReadMarket("test_dense.mtx");
+  for (int i = 0; i < 300; ++i) {
+    for (int j = 0; j < 300; ++j) ASSERT_EQ(read(i, j), m(i, j));
+  }
+
+  std::vector<S21Triplet> triplets;
+  for (int i = 0; i < 400; ++i) triplets.push_back({i, (i * 7) % 500, 0.1 * i});
+  triplets.push_back({3, 21, 1.0});  // повтор складывается
+  S21SparseMatrix sparse = S21SparseMatrix::FromTriplets(400, 500, triplets);
+  ASSERT_EQ(sparse.GetNonZeros(), 399u);  // 0.1 * 0 отброшен
+  ASSERT_DOUBLE_EQ(sparse(3, 21), 1.3);
+  EXPECT_THROW(S21SparseMatrix(-5, 3), std::invalid_argument);
+  EXPECT_THROW(S21SparseMatrix(3, -1), std::invalid_argument);
+  S21WriteMarket("test_sparse.mtx", sparse);
+  std::variant<S21Matrix, S21SparseMatrix> loaded =
+      S21LoadMarket("test_sparse.mtx");
+  ASSERT_TRUE(std::holds_alternative<S21SparseMatrix>(loaded));
+  const S21SparseMatrix &back = std::get<S21SparseMatrix>(loaded);
+  ASSERT_EQ(back.Columns(), sparse.Columns());
+  ASSERT_EQ(back.Values(), sparse.Values());
+  ASSERT_TRUE(std::holds_alternative<S21Matrix>(
+      S21LoadMarket("test_sparse.mtx", 0.001)));
+
+  // построчный операнд не копируется: выделяется только результат
+  S21Matrix dense = MakeWavy(500, 3, 25);
+  S21AllocStats before = S21MatrixAllocStats();
+  S21Matrix product = sparse.Multiply(dense);
+  ASSERT_EQ(S21MatrixAllocStats().allocations - before.allocations, 1u);
+  ASSERT_TRUE(product.EqMatrix(sparse.ToDense() * dense));
+  ASSERT_TRUE(sparse.Multiply(dense.InLayout(S21Layout::kColMajor))
+                  .EqMatrix(product));
+  std::remove("test_dense.mtx");
+  std::remove("test_sparse.mtx");
+}
+
+TEST(Market, Formats) {
+  auto write = [](const char *text) {
+    std::ofstream("test_format.mtx") << text;
+  };
+  write("%%MatrixMarket matrix array real skew-symmetric\n3 3\n1\n2\n3\n");
+  S21Matrix skew = S21ReadMarket("test_format.mtx");
+  ASSERT_DOUBLE_EQ(skew(1, 0), 1.0);
+  ASSERT_DOUBLE_EQ(skew(0, 1), -1.0);
+  ASSERT_DOUBLE_EQ(skew(2, 1), 3.0);
+  ASSERT_DOUBLE_EQ(skew(1, 1), 0.0);
+
+  write("%%MatrixMarket Matrix Coordinate Pattern General\n2 3 2\n1 3\n2 1");
+  S21Matrix pattern = S21ReadMarket("test_format.mtx");
+  ASSERT_DOUBLE_EQ(pattern(0, 2), 1.0);
+  ASSERT_DOUBLE_EQ(pattern(1, 0), 1.0);
+
+  write("%%MatrixMarket matrix coordinate real general\n2 2 3\n1 1 1\n");
+  EXPECT_THROW(S21ReadMarket("test_format.mtx"), std::invalid_argument);
+  write("%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n");
+  EXPECT_THROW(S21ReadMarket("test_format.mtx"), std::invalid_argument);
+  write("%%MatrixMarket matrix coordinate complex general\n1 1 1\n1 1 1 0\n");
+  EXPECT_THROW(S21ReadMarket("test_format.mtx"), std::invalid_argument);
+  write("%%MatrixMarket matrix array real general\n1 2\n1.5\nabc\n");
+  EXPECT_THROW(S21ReadMarket("test_format.mtx"), std::invalid_argument);
+  std::remove("test_format.mtx");
+}
+
+TEST(Banded, Tridiagonal) {
+  const int n = 40;
+  S21TridiagonalMatrix a(n);
+  for (int i = 0; i < n; ++i) {
+    a(i, i) = 4.0 + std::sin(i);
+    if (i > 0) a(i, i - 1) = -1.0 + 0.1 * i;
+    if (i + 1 < n) a(i, i + 1) = std::cos(i);
+  }
+  EXPECT_THROW(a(0, 2), std::invalid_argument);
+  const S21TridiagonalMatrix &ca = a;
+  ASSERT_DOUBLE_EQ(ca(0, 2), 0.0);
+  S21Matrix dense = a.ToDense();
+  ASSERT_TRUE(S21TridiagonalMatrix::FromDense(dense).ToDense().EqMatrix(dense));
+
+  S21Matrix x = MakeWavy(n, 3, 16);
+  S21Matrix b = a.Multiply(x, S21ExecutionPolicy::kPar);
+  ASSERT_TRUE(b.EqMatrix(dense * x));
+  ASSERT_TRUE(a.Solve(b).EqMatrix(x));
+  // колонночная правая часть
+  ASSERT_TRUE(a.Solve(b.InLayout(S21Layout::kColMajor)).EqMatrix(x));
+
+  // нулевой ведущий элемент прогонки: решение через ленточное LU
+  S21TridiagonalMatrix swap({1.0}, {0.0, 2.0}, {3.0});
+  S21Matrix rhs(2, 1);
+  rhs(0, 0) = 6.0;
+  rhs(1, 0) = 5.0;
+  S21Matrix solution = swap.Solve(rhs);
+  ASSERT_DOUBLE_EQ(solution(0, 0), 1.0);
+  ASSERT_DOUBLE_EQ(solution(1, 0), 2.0);
+  EXPECT_THROW(S21TridiagonalMatrix({1.0}, {1.0}, {1.0}),
+               std::invalid_argument);
+}
+
+TEST(Banded, LargeTridiagonal) {
+  // миллион неизвестных: O(n) времени и памяти
+  const int n = 1000000;
+  S21TridiagonalMatrix a(std::vector<double>(n - 1, -1.0),
+                         std::vector<double>(n, 2.0),
+                         std::vector<double>(n - 1, -1.0));
+  S21Matrix x(n, 1);
+  x.Apply([](double) { return 1.0; });
+  S21Matrix b = a.Multiply(x);
+  S21Matrix solved = a.Solve(b);
+  ASSERT_NEAR(solved(0, 0), 1.0, 1e-6);
+  ASSERT_NEAR(solved(n / 2, 0), 1.0, 1e-6);
+  ASSERT_NEAR(solved(n - 1, 0), 1.0, 1e-6);
+}
+
+TEST(Banded, ScaledSystem) {
+  // диагональное преобладание, но все элементы меньше EPS
+  const int n = 50;
+  S21TridiagonalMatrix a(std::vector<double>(n - 1, -1e-8),
+                         std::vector<double>(n, 4e-8),
+                         std::vector<double>(n - 1, -1e-8));
+  S21Matrix x = MakeWavy(n, 2, 24);
+  S21Matrix b = a.Multiply(x);
+  S21Matrix error = a.Solve(b) - x;
+  ASSERT_LT(error.NormInf(), 1e-9);
+  error = S21BandedMatrix(a).Solve(b) - x;
+  ASSERT_LT(error.NormInf(), 1e-9);
+}
+
+TEST(Banded, BandedLU) {
+  const int n = 30;
+  S21Matrix dense(n, n);
+  for (int i = 0; i < n; ++i) {
+    for (int j = std::max(0, i - 2); j <= std::min(n - 1, i + 1); ++j) {
+      dense(i, j) = std::sin(1.7 * i + 0.3 * j) + (i == j ? 0.1 : 0.0);
+    }
+  }
+  S21BandedMatrix a = S21BandedMatrix::FromDense(dense, 2, 1);
+  ASSERT_EQ(a.GetLowerBandwidth(), 2);
+  ASSERT_TRUE(a.ToDense().EqMatrix(dense));
+  EXPECT_THROW(a(0, 5) = 1.0, std::invalid_argument);
+
+  S21Matrix x = MakeWavy(n, 2, 17);
+  S21Matrix b = a.Multiply(x, S21ExecutionPolicy::kPar);
+  ASSERT_TRUE(b.EqMatrix(dense * x));
+  S21Matrix residual = dense * a.Solve(b) - b;
+  ASSERT_LT(residual.NormInf(), 1e-9);
+  S21Matrix error = a.Solve(b) - x;
+  ASSERT_LT(error.NormInf(), 1e-6);
+
+  S21BandedMatrix singular(3, 1, 1);
+  EXPECT_THROW(singular.Solve(S21Matrix(3, 1)), std::logic_error);
+  EXPECT_THROW(S21BandedMatrix(3, 3, 0), std::invalid_argument);
+}
+
+TEST(Packed, Symmetric) {
+  const int n = 37;
+  S21Matrix half = MakeWavy(n, n, 18);
+  S21Matrix dense = half + half.Transpose();
+  S21SymmetricMatrix a = S21SymmetricMatrix::FromDense(dense);
+  ASSERT_EQ(a.Packed().size(), static_cast<std::size_t>(n * (n + 1) / 2));
+  ASSERT_TRUE(a.ToDense().EqMatrix(dense));
+  a(3, 5) = 7.0;
+  ASSERT_DOUBLE_EQ(a(5, 3), 7.0);
+  dense(3, 5) = dense(5, 3) = 7.0;
+  EXPECT_THROW(a(n, 0), std::invalid_argument);
+
+  S21Matrix b = MakeWavy(n, 4, 19);
+  ASSERT_TRUE(a.Multiply(b).EqMatrix(dense * b));
+  ASSERT_TRUE(a.Multiply(b.InLayout(S21Layout::kColMajor),
+                         S21ExecutionPolicy::kPar)
+                  .EqMatrix(dense * b));
+
+  // C = 2 A A^T - C
+  S21Matrix k = MakeWavy(n, 5, 20);
+  a.RankKUpdate(2.0, k, -1.0, S21ExecutionPolicy::kPar);
+  ASSERT_TRUE(a.ToDense().EqMatrix(k * k.Transpose() * 2.0 - dense));
+  a.RankKUpdate(1.0, k, 0.0);
+  ASSERT_TRUE(a.ToDense().EqMatrix(k * k.Transpose()));
+  EXPECT_THROW(a.RankKUpdate(1.0, S21Matrix(n + 1, 2)),
+               std::invalid_argument);
+}
+
+TEST(Packed, Triangular) {
+  const int n = 29;
+  S21Matrix dense = MakeWavy(n, n, 21);
+  for (int i = 0; i < n; ++i) dense(i, i) += 3.0;
+  S21Matrix x = MakeWavy(n, 3, 22);
+  for (S21Triangle triangle : {S21Triangle::kLower, S21Triangle::kUpper}) {
+    S21TriangularMatrix t = S21TriangularMatrix::FromDense(dense, triangle);
+    S21Matrix full = t.ToDense();
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        bool inside = triangle == S21Triangle::kLower ? j <= i : j >= i;
+        ASSERT_DOUBLE_EQ(full(i, j), inside ? dense(i, j) : 0.0);
+      }
+    }
+    S21Matrix b = t.Multiply(x, S21ExecutionPolicy::kPar);
+    ASSERT_TRUE(b.EqMatrix(full * x));
+    ASSERT_TRUE(t.Solve(b).EqMatrix(x));
+    S21Matrix bt = full.Transpose() * x;
+    ASSERT_TRUE(t.Solve(bt.InLayout(S21Layout::kColMajor), true).EqMatrix(x));
+  }
+  // все элементы меньше EPS, но система не вырождена
+  S21TriangularMatrix scaled = S21TriangularMatrix::FromDense(
+      dense * 1e-9, S21Triangle::kLower);
+  S21Matrix error = scaled.Solve(scaled.Multiply(x)) - x;
+  ASSERT_LT(error.NormInf(), 1e-9);
+  S21TriangularMatrix upper(3, S21Triangle::kUpper);
+  EXPECT_THROW(upper(2, 0) = 1.0, std::invalid_argument);
+  const S21TriangularMatrix &cupper = upper;
+  ASSERT_DOUBLE_EQ(cupper(2, 0), 0.0);
+  EXPECT_THROW(upper.Solve(S21Matrix(3, 1)), std::logic_error);
+  EXPECT_THROW(S21TriangularMatrix(0, S21Triangle::kLower),
+               std::invalid_argument);
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();